@@ -0,0 +1,430 @@
+// Microbenchmarks for the hot paths: ReadyBuffer intake, Bankers
+// admission, Scheduler::run, workload generation and page replacement.
+// Prints one JSON document with a stable layout:
+// {"benchmarks":[{"suite","name","params":{..},"ops","ns_per_op","ops_per_sec","peak_rss_kb"}, ..]}
+// Every configuration runs in its own forked child; peak_rss_kb is that
+// child's high-water mark.
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/bankers.hpp"
+#include "../src/paging.hpp"
+#include "../src/ready_buffer.hpp"
+#include "../src/resource_kernels.hpp"
+#include "../src/scheduler.hpp"
+#include "../src/workload.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+bool g_quick = false;
+bool g_first = true;
+int g_record_fd = -1;   // in a configuration's child: pipe to the parent
+
+// params is a pre-rendered JSON object body, e.g. "\"n\":100". Called in
+// the child; the record is completed and printed by isolated().
+void report(const char* suite, const std::string& name, const std::string& params,
+            long long ops, double seconds) {
+    double ns = ops > 0 ? seconds * 1e9 / ops : 0;
+    double per_sec = seconds > 0 ? ops / seconds : 0;
+    std::string line = "{\"suite\":\"" + std::string(suite) + "\",\"name\":\"" + name + "\",\"params\":{" +
+                       params + "},\"ops\":" + std::to_string(ops);
+    char tail[96];
+    std::snprintf(tail, sizeof tail, ",\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f\n", ns, per_sec);
+    line += tail;
+    for (size_t done = 0; done < line.size();) {
+        ssize_t n = write(g_record_fd, line.data() + done, line.size() - done);
+        if (n <= 0) _exit(1);
+        done += static_cast<size_t>(n);
+    }
+}
+
+// Runs one configuration in a forked child. RUSAGE_SELF's ru_maxrss only
+// ever grows, so it cannot tell configurations apart; wait4 reports the
+// child's own peak. The child's records come back through a pipe.
+void isolated(const std::function<void()>& body) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        std::exit(1);
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        g_record_fd = fds[1];
+        body();
+        _exit(0);
+    }
+
+    close(fds[1]);
+    std::string records;
+    char buf[4096];
+    for (ssize_t n; (n = read(fds[0], buf, sizeof buf)) != 0;) {
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        records.append(buf, static_cast<size_t>(n));
+    }
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage ru{};
+    while (wait4(pid, &status, 0, &ru) < 0 && errno == EINTR) {}
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::fprintf(stderr, "benchmark child failed\n");
+        std::exit(1);
+    }
+    for (size_t at = 0, nl; (nl = records.find('\n', at)) != std::string::npos; at = nl + 1) {
+        std::printf("%s\n  %s,\"peak_rss_kb\":%ld}", g_first ? "" : ",", records.substr(at, nl - at).c_str(),
+                    ru.ru_maxrss); // kilobytes on Linux
+        g_first = false;
+    }
+    std::fflush(stdout);
+}
+
+double since(clock_type::time_point t0) {
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+}
+
+// ---------------- ReadyBuffer: producers x capacity ----------------
+
+void bench_ring() {
+    const long long total = g_quick ? 100000 : 1000000;
+    for (int producers : {1, 2, 4, 8}) {
+        for (size_t cap : {4, 64, 1024}) {
+            isolated([&] {
+                ReadyBuffer buf(cap);
+                long long per = total / producers;
+
+                auto t0 = clock_type::now();
+                std::thread consumer([&] {
+                    std::vector<Process> got;
+                    long long seen = 0;
+                    while (seen < per * producers) {
+                        got.clear();
+                        seen += static_cast<long long>(buf.pop_bulk(got, 64));
+                    }
+                });
+                std::vector<std::thread> ps;
+                for (int p = 0; p < producers; p++) {
+                    ps.emplace_back([&, p] {
+                        for (long long i = 0; i < per; i++)
+                            buf.push(Process(static_cast<int>(p * per + i), 0, 1, 1, {1, 0, 1}));
+                    });
+                }
+                for (auto& t : ps) t.join();
+                consumer.join();
+                double s = since(t0);
+
+                report("ready_buffer", "push_pop",
+                       "\"producers\":" + std::to_string(producers) + ",\"capacity\":" + std::to_string(cap),
+                       per * producers, s);
+            });
+        }
+    }
+}
+
+// ---------------- Bankers: processes x resources ----------------
+
+void bench_banker() {
+    std::vector<size_t> sizes = g_quick ? std::vector<size_t>{100, 1000}
+                                        : std::vector<size_t>{100, 1000, 10000};
+    for (size_t n : sizes) {
+        for (size_t m : {3, 16, 64}) {
+            isolated([&] {
+                std::mt19937 rng(42);
+                // Plenty of every resource so resident processes stay admitted
+                Bankers b(std::vector<int>(m, static_cast<int>(n) * 4));
+                for (size_t p = 0; p < n; p++) {
+                    std::vector<int> claim(m);
+                    for (auto& c : claim) c = static_cast<int>(rng() % 3);
+                    b.admit(static_cast<int>(p), claim);
+                }
+
+                std::vector<int> claim(m, 1);
+                long long iters = std::max<long long>(20, static_cast<long long>((g_quick ? 2e6 : 2e7) / (n * m)));
+                int pid = static_cast<int>(n);
+                auto t0 = clock_type::now();
+                for (long long i = 0; i < iters; i++) {
+                    b.admit(pid, claim);
+                    b.release_all(pid);
+                }
+                double s = since(t0);
+                report("bankers", "request_release",
+                       "\"processes\":" + std::to_string(n) + ",\"resources\":" + std::to_string(m),
+                       iters, s);
+
+                // Batch admission of 64 new processes at once
+                std::vector<Process> batch;
+                for (int k = 0; k < 64; k++) batch.emplace_back(pid + 1 + k, 0, 1, 1, claim);
+                long long rounds = std::max<long long>(5, iters / 64);
+                t0 = clock_type::now();
+                for (long long i = 0; i < rounds; i++) {
+                    b.request_batch(batch);
+                    for (auto& p : batch) b.release_all(p.pid);
+                }
+                s = since(t0);
+                report("bankers", "request_batch_64",
+                       "\"processes\":" + std::to_string(n) + ",\"resources\":" + std::to_string(m),
+                       rounds * 64, s);
+            });
+        }
+    }
+}
+
+// ---------------- Bankers: full-claim vs incremental vs detection ----------------
+
+// A fixed population of processes, each acquiring its claim in kChunks
+// increments and releasing everything once it holds all of it:
+//   full_claim - the whole claim is reserved at admission (admit)
+//   avoidance  - incremental request() with a safety check per grant
+//   detection  - incremental request(), periodic detection + recovery
+// One op = one completed process. Utilisation is the mean fraction of all
+// units that processes have actually acquired (reserved-but-unused units of
+// full_claim do not count).
+void bench_incremental() {
+    constexpr int kSlots = 64;
+    constexpr int kChunks = 4;
+    const long long steps = g_quick ? 100000 : 1000000;
+    const char* modes[] = {"full_claim", "avoidance", "detection"};
+
+    for (size_t m : {3, 16}) {
+        const int capacity = kSlots * 2;
+        for (const char* mode : modes) {
+            isolated([&] {
+                std::mt19937 rng(9);
+                Bankers b(std::vector<int>(m, capacity));
+                bool full = std::strcmp(mode, "full_claim") == 0;
+                if (std::strcmp(mode, "detection") == 0) b.set_mode(BankerMode::Detection, kSlots);
+
+                struct Slot { int pid; int step; bool admitted; ResourceVector claim, held; };
+                std::vector<Slot> slots(kSlots);
+                int next_pid = 1;
+                auto spawn = [&](Slot& sl) {
+                    sl = {next_pid++, 0, false, ResourceVector(m, 0), ResourceVector(m, 0)};
+                    for (size_t j = 0; j < m; j++) sl.claim[j] = 1 + static_cast<int>(rng() % (capacity / 16));
+                    if (!full) b.declare(sl.pid, sl.claim);
+                };
+                for (auto& sl : slots) spawn(sl);
+
+                long long completed = 0, aborted = 0, used = 0;
+                double util_sum = 0;
+                ResourceVector delta(m, 0);
+                auto t0 = clock_type::now();
+                for (long long i = 0; i < steps; i++) {
+                    Slot& sl = slots[rng() % kSlots];
+                    // Next increment: an even share of the claim, the rest on the last chunk
+                    for (size_t j = 0; j < m; j++)
+                        delta[j] = sl.step + 1 == kChunks ? sl.claim[j] - sl.held[j] : sl.claim[j] / kChunks;
+
+                    bool got;
+                    if (full) {
+                        if (!sl.admitted) sl.admitted = b.admit(sl.pid, sl.claim);
+                        got = sl.admitted;
+                    } else {
+                        got = b.request(sl.pid, delta) == Grant::Granted;
+                    }
+                    if (got) {
+                        for (size_t j = 0; j < m; j++) sl.held[j] += delta[j], used += delta[j];
+                        if (++sl.step == kChunks) {
+                            b.release_all(sl.pid);
+                            for (size_t j = 0; j < m; j++) used -= sl.held[j];
+                            completed++;
+                            spawn(sl);
+                        }
+                    }
+                    for (int victim : b.take_aborted()) {
+                        for (auto& v : slots) {
+                            if (v.pid != victim) continue;
+                            for (size_t j = 0; j < m; j++) used -= v.held[j];
+                            aborted++;
+                            spawn(v);
+                        }
+                    }
+                    util_sum += static_cast<double>(used) / (static_cast<double>(capacity) * m);
+                }
+                double s = since(t0);
+
+                char extra[160];
+                std::snprintf(extra, sizeof extra,
+                              ",\"steps\":%lld,\"completed\":%lld,\"aborted\":%lld,\"utilization\":%.3f",
+                              steps, completed, aborted, util_sum / steps);
+                report("bankers", std::string("incremental_") + mode,
+                       "\"resources\":" + std::to_string(m) + extra, completed, s);
+            });
+        }
+    }
+}
+
+// ---------------- Bankers row kernels: width x ISA ----------------
+
+// One op = leq + add + sub over an m-wide row (what a grant/rollback costs)
+void bench_kernels() {
+    const long long elems = g_quick ? 20000000 : 200000000;
+    for (size_t m : {3, 8, 16, 64, 256}) {
+        std::vector<int> a(m, 1), b(m, 2), dst(m, 0);
+        std::vector<ResourceKernels> variants;
+        if (m <= kMaxFixedWidth) variants.push_back(select_kernels(m));
+        for (KernelIsa isa : {KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2})
+            if (isa <= detected_isa()) variants.push_back(kernels_for(isa));
+
+        for (const auto& k : variants) {
+            isolated([&] {
+                long long iters = std::max<long long>(1000, elems / static_cast<long long>(m));
+                bool ok = true;
+                auto t0 = clock_type::now();
+                for (long long i = 0; i < iters; i++) {
+                    ok &= k.leq(a.data(), b.data(), m);
+                    k.add(dst.data(), a.data(), m);
+                    k.sub(dst.data(), b.data(), m);
+                    asm volatile("" : : "r"(dst.data()) : "memory");
+                }
+                double s = since(t0);
+                if (!ok || dst[0] != -iters) std::fprintf(stderr, "kernel check failed\n");
+                std::string name = k.fixed_width ? "fixed" : isa_name(k.isa);
+                report("bankers", "kernels_" + name, "\"resources\":" + std::to_string(m), iters, s);
+            });
+        }
+    }
+}
+
+// ---------------- Scheduler: workload size x policy ----------------
+
+void bench_scheduler() {
+    const SchedPolicy policies[] = {
+        SchedPolicy::Priority, SchedPolicy::PriorityPreemptive, SchedPolicy::RoundRobin,
+        SchedPolicy::RoundRobinRounds, SchedPolicy::Srtf, SchedPolicy::Mlfq, SchedPolicy::Cfs,
+        SchedPolicy::Edf,
+    };
+    std::vector<int> sizes = g_quick ? std::vector<int>{1000, 10000}
+                                     : std::vector<int>{1000, 10000, 100000};
+
+    // "short" bursts keep the queue small; "long" bursts build a deep RR queue
+    struct Workload { const char* name; int burst_max; int max_n; };
+    const Workload workloads[] = {{"short", 20, 1 << 30}, {"long", 2000, 10000}};
+
+    for (const auto& w : workloads)
+    for (int n : sizes) {
+        if (n > w.max_n) continue; // per-quantum RR output would not fit in memory
+        std::mt19937 rng(7);
+        std::vector<Process> procs;
+        procs.reserve(n);
+        for (int i = 0; i < n; i++)
+            procs.emplace_back(i + 1, i * 2, 1 + static_cast<int>(rng() % w.burst_max),
+                               static_cast<int>(rng() % 8), std::vector<int>{});
+
+        for (SchedPolicy policy : policies) {
+            for (int q : {1, 4, 16}) {
+                if (!Scheduler::uses_quantum(policy) && q != 4) continue;
+                isolated([&] {
+                    auto t0 = clock_type::now();
+                    auto res = Scheduler::run(procs, policy, q);
+                    double s = since(t0);
+                    report("scheduler", Scheduler::policy_name(policy),
+                           "\"workload\":\"" + std::string(w.name) + "\",\"processes\":" + std::to_string(n) +
+                           ",\"quantum\":" + std::to_string(q) +
+                           ",\"gantt_entries\":" + std::to_string(res.gantt.size() + res.rounds.size()),
+                           n, s);
+                });
+            }
+        }
+    }
+}
+
+// ---------------- Workload generators: arrivals x bursts x m ----------------
+
+void bench_workload() {
+    const uint64_t n = g_quick ? 200000 : 2000000;
+    for (ArrivalModel arrivals : {ArrivalModel::Poisson, ArrivalModel::Bursty})
+    for (BurstModel bursts : {BurstModel::Exponential, BurstModel::Pareto})
+    for (size_t m : {3, 16}) {
+        isolated([&] {
+            WorkloadConfig cfg;
+            cfg.count = n;
+            cfg.resources = m;
+            cfg.arrivals = arrivals;
+            cfg.bursts = bursts;
+            WorkloadGenerator gen(cfg);
+            Process p;
+            long long checksum = 0;
+            auto t0 = clock_type::now();
+            while (gen.next(p)) checksum += p.burst_time + p.max_need[m - 1];
+            double s = since(t0);
+            report("workload", "generate",
+                   std::string("\"arrivals\":\"") + (arrivals == ArrivalModel::Poisson ? "poisson" : "bursty") +
+                   "\",\"bursts\":\"" + (bursts == BurstModel::Pareto ? "pareto" : "exp") +
+                   "\",\"m\":" + std::to_string(m) + ",\"checksum\":" + std::to_string(checksum),
+                   static_cast<long long>(n), s);
+        });
+    }
+}
+
+// ---------------- Paging: replacement policy x frames, TLB on ----------------
+
+void bench_paging() {
+    RefConfig cfg;
+    cfg.count = g_quick ? 2000000 : 20000000;
+    cfg.processes = 16;
+    cfg.pages = 8192;
+    cfg.hot = 128;
+    cfg.hot_prob = 0.98;
+    cfg.scan = 0.01;
+    const std::string path = "/tmp/sim_bench_" + std::to_string(getpid()) + ".refs";
+    write_ref_trace(path, cfg);
+    for (uint32_t frames : {1024u, 4096u})
+    for (Replacement r : {Replacement::Fifo, Replacement::Lru, Replacement::Clock, Replacement::Arc}) {
+        isolated([&] {
+            RefTrace trace(path);   // mapped in the child, so its pages count there
+            auto t0 = clock_type::now();
+            PagingStats st = simulate_paging(trace.data(), trace.size(), {r, frames, 64});
+            double s = since(t0);
+            report("paging", replacement_name(r),
+                   "\"frames\":" + std::to_string(frames) + ",\"faults\":" + std::to_string(st.faults),
+                   static_cast<long long>(trace.size()), s);
+        });
+    }
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string only;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) g_quick = true;
+        else if (std::strcmp(argv[i], "--suite") == 0 && i + 1 < argc) only = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: sim_bench [--quick] [--suite ready_buffer|bankers|scheduler|workload|paging]\n");
+            return 2;
+        }
+    }
+
+    std::printf("{\"benchmarks\":[");
+    if (only.empty() || only == "ready_buffer") bench_ring();
+    if (only.empty() || only == "bankers") {
+        bench_banker();
+        bench_incremental();
+        bench_kernels();
+    }
+    if (only.empty() || only == "scheduler") bench_scheduler();
+    if (only.empty() || only == "workload") bench_workload();
+    if (only.empty() || only == "paging") bench_paging();
+    std::printf("\n]}\n");
+    return 0;
+}
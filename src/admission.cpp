@@ -0,0 +1,80 @@
+#include "admission.hpp"
+#include <mutex>
+
+bool ConcurrentAdmission::infeasible(const std::vector<const Process*>& batch,
+                                     const BatchAdmission& decided) const {
+    const std::vector<int>& total = master_.total();
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (decided.admitted[i] || batch[i]->max_need.size() != total.size()) continue;
+        for (size_t j = 0; j < total.size(); j++)
+            if (batch[i]->max_need[j] > total[j]) return true;
+    }
+    return false;
+}
+
+void ConcurrentAdmission::catch_up(Replica& replica) {
+    if (replica.version_ == version_ && replica.touched_.empty()) return;
+    if (replica.version_ > version_ || version_ - replica.version_ > kLogCommits) {
+        replica.state_.sync_from(master_);
+    } else {
+        replica.rows_.swap(replica.touched_);
+        for (uint64_t v = replica.version_ + 1; v <= version_; v++) {
+            const std::vector<int>& pids = log_[v % kLogCommits];
+            replica.rows_.insert(replica.rows_.end(), pids.begin(), pids.end());
+        }
+        replica.state_.sync_rows_from(master_, replica.rows_);
+    }
+    replica.rows_.clear();
+    replica.touched_.clear();
+    replica.version_ = version_;
+}
+
+void ConcurrentAdmission::commit(const std::vector<const Process*>& batch) {
+    version_++;
+    std::vector<int>& pids = log_[version_ % kLogCommits];
+    pids.clear();
+    for (const Process* p : batch)
+        if (p->max_need.size() == master_.resource_count()) pids.push_back(p->pid);
+}
+
+BatchAdmission ConcurrentAdmission::admit(const std::vector<const Process*>& batch, Replica& replica) {
+    for (int attempt = 0; attempt < kMaxAttempts; attempt++) {
+        uint64_t seen;
+        {
+            std::shared_lock<std::shared_mutex> lock(mtx_);
+            seen = version_;
+            catch_up(replica);
+        }
+        // The replica now diverges from the master in these rows
+        for (const Process* p : batch)
+            if (p->max_need.size() == master_.resource_count()) replica.touched_.push_back(p->pid);
+
+        // Speculate without holding any lock
+        BatchAdmission decided = replica.state_.request_batch(batch);
+
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        bool exact = version_ == seen;
+        if (exact || (infeasible_version_ <= seen && master_.apply_admission(batch, decided, false))) {
+            if (exact) master_.apply_admission(batch, decided, true);
+            commit(batch);
+            // After an exact commit the replica matches the master again
+            // (up to row order, which no decision depends on)
+            if (exact) {
+                replica.version_ = version_;
+                replica.touched_.clear();
+            }
+            if (infeasible(batch, decided)) infeasible_version_ = version_;
+            commits_.fetch_add(1, std::memory_order_relaxed);
+            return decided;
+        }
+        conflicts_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Heavy contention: decide on the master itself
+    std::unique_lock<std::shared_mutex> lock(mtx_);
+    BatchAdmission decided = master_.request_batch(batch);
+    commit(batch);
+    if (infeasible(batch, decided)) infeasible_version_ = version_;
+    fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return decided;
+}
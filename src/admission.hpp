@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+#include "bankers.hpp"
+
+// Optimistic admission by several dispatcher threads over one Bankers.
+//
+// Every dispatcher owns a Replica. admit() brings the replica up to date
+// with the master under a shared lock, runs request_batch on the replica
+// without any lock, then commits under the exclusive lock:
+//   - master version unchanged => apply the decision as is
+//   - otherwise validate it (Bankers::apply_admission) and apply, or
+//     count a conflict and speculate again on a fresh copy
+// After kMaxAttempts conflicts the batch is admitted on the master under
+// the exclusive lock.
+//
+// A commit only changes the rows of its batch's pids (and available), so
+// each commit logs those pids. Catching up re-copies the rows logged since
+// the replica's version plus the rows its own speculation touched; only a
+// replica more than kLogCommits behind copies the whole master.
+//
+// Every commit leaves the master in a state the Banker's algorithm
+// accepts; the master must not be touched directly while dispatchers are
+// running.
+class ConcurrentAdmission {
+public:
+    static constexpr int kMaxAttempts = 4;
+    static constexpr uint64_t kLogCommits = 256;
+
+    class Replica {
+    public:
+        explicit Replica(const Bankers& master) : state_(master.total()) {}
+
+    private:
+        friend class ConcurrentAdmission;
+        Bankers state_;
+        uint64_t version_{UINT64_MAX};  // master version state_ matches, but for touched_
+        std::vector<int> touched_;      // pids speculated on since
+        std::vector<int> rows_;         // catch-up scratch
+    };
+
+    explicit ConcurrentAdmission(Bankers& master) : master_(master) {}
+
+    BatchAdmission admit(const std::vector<const Process*>& batch, Replica& replica);
+
+    uint64_t commits() const { return commits_.load(std::memory_order_relaxed); }
+    uint64_t conflicts() const { return conflicts_.load(std::memory_order_relaxed); }
+    uint64_t fallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+
+private:
+    Bankers& master_;
+    std::shared_mutex mtx_;
+    uint64_t version_{0};              // bumped by every commit (mtx_)
+    // Version of the last commit that registered a claim larger than the
+    // total: such a claim makes the state unsafe, so grants validated
+    // against an older copy must not go through
+    uint64_t infeasible_version_{0};
+    // Pids of commit v at v % kLogCommits (mtx_)
+    std::vector<std::vector<int>> log_ = std::vector<std::vector<int>>(kLogCommits);
+
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> conflicts_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+
+    bool infeasible(const std::vector<const Process*>& batch, const BatchAdmission& decided) const;
+    // Caller holds mtx_ (shared)
+    void catch_up(Replica& replica);
+    // Caller holds mtx_ exclusively; bumps version_
+    void commit(const std::vector<const Process*>& batch);
+};
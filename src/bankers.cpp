@@ -1,105 +1,686 @@
 #include "bankers.hpp"
+#include <algorithm>
+#include <numeric>
 #include <stdexcept>
+#include <string>
+#include "metrics.hpp"
 
 Bankers::Bankers(std::vector<int> available)
-    : available_(std::move(available)) {
+    : m_(available.size()), available_(std::move(available)), total_(available_),
+      kernels_(select_kernels(m_)) {
     if (available_.empty()) throw std::invalid_argument("available vector must not be empty");
+    work_.resize(m_);
+    cursor_.resize(m_);
+    grant_.resize(m_);
 }
 
-bool Bankers::leq(const std::vector<int>& a, const std::vector<int>& b) {
-    if (a.size() != b.size()) return false;
-    for (size_t i = 0; i < a.size(); i++) if (a[i] > b[i]) return false;
-    return true;
-}
+size_t Bankers::row_for(int pid) {
+    size_t found = row_of_.find(pid);
+    if (found != PidRowMap::npos) return found;
 
-std::vector<int> Bankers::add(const std::vector<int>& a, const std::vector<int>& b) {
-    std::vector<int> r(a.size(), 0);
-    for (size_t i = 0; i < a.size(); i++) r[i] = a[i] + b[i];
+    size_t r = pids_.size();
+    pids_.push_back(pid);
+    order_pos_.push_back(0);
+    row_of_.insert_or_assign(pid, r);
+    allocation_.resize((r + 1) * m_, 0);
+    max_need_.resize((r + 1) * m_, 0);
+    need_.resize((r + 1) * m_, 0);
+    pending_req_.resize((r + 1) * m_, 0);
     return r;
 }
 
-std::vector<int> Bankers::sub(const std::vector<int>& a, const std::vector<int>& b) {
-    std::vector<int> r(a.size(), 0);
-    for (size_t i = 0; i < a.size(); i++) r[i] = a[i] - b[i];
-    return r;
+void Bankers::erase_row(size_t row) {
+    size_t last = pids_.size() - 1;
+    if (row != last) {
+        std::copy_n(alloc_row(last), m_, alloc_row(row));
+        std::copy_n(max_row(last), m_, max_row(row));
+        std::copy_n(need_row(last), m_, need_row(row));
+        std::copy_n(pending_row(last), m_, pending_row(row));
+        pids_[row] = pids_[last];
+        order_pos_[row] = order_pos_[last];
+        row_of_.insert_or_assign(pids_[row], row);
+    }
+    pids_.pop_back();
+    order_pos_.pop_back();
+    allocation_.resize(last * m_);
+    max_need_.resize(last * m_);
+    need_.resize(last * m_);
+    pending_req_.resize(last * m_);
 }
 
-std::optional<std::vector<int>> Bankers::request_resources(int pid,
-                                                           const std::vector<int>& max_claim)
+std::optional<std::vector<int>> Bankers::request_resources(int pid, const int* max_claim, size_t m)
 {
-    // Save max claim
-    max_need_[pid] = max_claim;
+    if (!admit(pid, max_claim, m)) return std::nullopt;
+    return safe_sequence();   // a grant always leaves the order known
+}
 
-    // current allocation (default 0)
-    if (!allocation_.count(pid)) allocation_[pid] = std::vector<int>(available_.size(), 0);
+bool Bankers::admit(int pid, const int* max_claim, size_t m) {
+    ScopedLatency latency(Probe::RequestResources);
+    // A claim over a different number of resource types can never be satisfied
+    if (m != m_) return false;
+
+    // Save max claim (current allocation defaults to 0 for a new pid)
+    bool fresh = !row_of_.contains(pid);
+    size_t r = row_for(pid);
+    int* alloc = alloc_row(r);
+    int* maxc = max_row(r);
+    int* need = need_row(r);
+    bool same_claim = !fresh && std::equal(max_claim, max_claim + m_, maxc);
+    std::copy_n(max_claim, m_, maxc);
+    for (size_t j = 0; j < m_; j++) need[j] = maxc[j] - alloc[j];
 
     // In our lab design: when admitted to run, it requests its FULL max claim at once.
     // (Later you can extend to partial requests.)
-    const auto& alloc = allocation_.at(pid);
-    auto need = sub(max_need_.at(pid), alloc);
 
     // If need > available => cannot grant immediately
-    if (!leq(need, available_)) return std::nullopt;
+    if (!leq(need, available_.data(), m_)) {
+        // The registered claim can still finish last if it fits the total
+        if (fresh && order_valid_ && leq(maxc, total_.data(), m_)) order_push_back(r);
+        else if (!same_claim) order_valid_ = false;
+        return false;
+    }
 
-    // Tentatively allocate
-    auto old_avail = available_;
-    auto old_alloc = allocation_[pid];
+    // Tentatively allocate: the whole need moves to allocation, so need becomes 0
+    grant_.assign(need, need + m_);
+    sub_from(available_.data(), grant_.data(), m_);
+    add_to(alloc, grant_.data(), m_);
+    std::fill_n(need, m_, 0);
 
-    available_ = sub(available_, need);
-    allocation_[pid] = add(allocation_[pid], need);
+    // pid now needs nothing, so it can finish first and hand back at least
+    // what it held before; every other row then has at least the work it
+    // had in the last safe sequence. No check needed.
+    if (order_valid_) {
+        // A known pid's old entry goes stale
+        order_push_front(r);
+        if (!fresh) compact_order();
+        return true;
+    }
 
-    std::vector<int> safe_seq;
+    std::vector<int>& safe_seq = batch_seq_;
     if (!safety_check(safe_seq)) {
-        // rollback
-        available_ = old_avail;
-        allocation_[pid] = old_alloc;
-        return std::nullopt;
+        // rollback (row pointers are still valid: safety_check is const)
+        add_to(available_.data(), grant_.data(), m_);
+        sub_from(alloc, grant_.data(), m_);
+        std::copy(grant_.begin(), grant_.end(), need);
+        return false;
+    }
+
+    remember_order(safe_seq);
+    return true;
+}
+
+std::vector<int> Bankers::safe_sequence() const {
+    std::vector<int> seq;
+    if (!order_valid_) {
+        if (!safety_check(seq)) seq.clear();
+        return seq;
+    }
+    seq.reserve(pids_.size());
+    for (size_t k = 0; k < safe_order_.size(); k++)
+        if (order_live(k)) seq.push_back(safe_order_[k]);
+    return seq;
+}
+
+void Bankers::remember_order(const std::vector<int>& finish_order) {
+    safe_order_.assign(finish_order.begin(), finish_order.end());
+    order_front_ = 0;
+    for (size_t k = 0; k < finish_order.size(); k++)
+        order_pos_[row_of_.find(finish_order[k])] = static_cast<long long>(k);
+    order_valid_ = true;
+}
+
+bool Bankers::order_live(size_t k) const {
+    size_t r = row_of_.find(safe_order_[k]);
+    return r != PidRowMap::npos && order_pos_[r] == order_front_ + static_cast<long long>(k);
+}
+
+void Bankers::order_push_front(size_t r) {
+    safe_order_.push_front(pids_[r]);
+    order_pos_[r] = --order_front_;
+}
+
+void Bankers::order_push_back(size_t r) {
+    order_pos_[r] = order_front_ + static_cast<long long>(safe_order_.size());
+    safe_order_.push_back(pids_[r]);
+}
+
+void Bankers::compact_order() {
+    // While the order is valid every row has exactly one live entry
+    if (safe_order_.size() <= 2 * pids_.size() + 16) return;
+    reorder_.clear();
+    for (size_t k = 0; k < safe_order_.size(); k++)
+        if (order_live(k)) reorder_.push_back(safe_order_[k]);
+    remember_order(reorder_);
+}
+
+bool Bankers::reorder_after_grant(size_t r) {
+    const int pid = pids_[r];
+    std::copy(available_.begin(), available_.end(), work_.begin());
+    reorder_.clear();
+    bool placed = false;
+    auto place = [&] {
+        if (placed || !leq(need_row(r), work_.data(), m_)) return;
+        add_to(work_.data(), alloc_row(r), m_);
+        reorder_.push_back(pid);
+        placed = true;
+    };
+    for (size_t i = 0; i < safe_order_.size(); i++) {
+        if (!order_live(i)) continue;
+        int other = safe_order_[i];
+        if (other == pid) continue;
+        place();
+        size_t k = row_of_.find(other);
+        if (!leq(need_row(k), work_.data(), m_)) return false;
+        add_to(work_.data(), alloc_row(k), m_);
+        reorder_.push_back(other);
+    }
+    place();
+    if (!placed) return false;
+    remember_order(reorder_);
+    return true;
+}
+
+bool Bankers::batch_item_fits(const Process& p) const {
+    size_t r = row_of_.find(p.pid);
+    for (size_t j = 0; j < m_; j++) {
+        int alloc = r == PidRowMap::npos ? 0 : allocation_[r * m_ + j];
+        if (p.max_need[j] - alloc > available_[j]) return false;
+    }
+    return true;
+}
+
+// Rows are only created when a candidate is granted, so claims that are still
+// undecided do not take part in the safety checks. Grants are revoked in LIFO
+// order, which means a fresh row is always the last one when it is dropped.
+void Bankers::grant_batch_item(size_t i) {
+    BatchGrant& b = batch_[i];
+    b.fresh = !row_of_.contains(b.proc->pid);
+    b.row = row_for(b.proc->pid);
+
+    size_t r = b.row;
+    std::copy(b.proc->max_need.begin(), b.proc->max_need.end(), max_row(r));
+    int* g = &batch_grant_[i * m_];
+    for (size_t j = 0; j < m_; j++) g[j] = max_row(r)[j] - alloc_row(r)[j];
+
+    sub_from(available_.data(), g, m_);
+    add_to(alloc_row(r), g, m_);
+    std::fill_n(need_row(r), m_, 0);
+}
+
+void Bankers::revoke_batch_item(size_t i) {
+    const BatchGrant& b = batch_[i];
+    const int* g = &batch_grant_[i * m_];
+    add_to(available_.data(), g, m_);
+
+    if (b.fresh) {
+        row_of_.erase(b.proc->pid);
+        erase_row(b.row);
+        return;
     }
+    sub_from(alloc_row(b.row), g, m_);
+    std::copy_n(g, m_, need_row(b.row));
+}
 
-    return safe_seq;
+// Granting a full need never makes an unsafe state safe: if "prefix + p" is
+// safe then "prefix" is too. So the admissible part of an ordered candidate
+// list is a prefix, found with one optimistic check or a binary search. The
+// candidate right after that prefix can never become safe later in the batch
+// (more grants only shrink what is left), so it is rejected and the remaining
+// candidates are retried. Each round costs 1 + log(k) safety checks.
+BatchAdmission Bankers::request_batch(const std::vector<Process>& batch) {
+    batch_procs_.clear();
+    for (const auto& p : batch) batch_procs_.push_back(&p);
+    return request_batch(batch_procs_);
+}
+
+BatchAdmission Bankers::request_batch(const std::vector<const Process*>& batch) {
+    ScopedLatency latency(Probe::RequestBatch);
+    BatchAdmission out;
+    bool cached = order_valid_, checked = false;
+    order_valid_ = false;
+    out.admitted.assign(batch.size(), false);
+
+    // A repeated pid keeps its first entry only (pairs sort by pid, then index)
+    by_pid_.clear();
+    for (size_t i = 0; i < batch.size(); i++)
+        if (batch[i]->max_need.size() == m_) by_pid_.push_back({batch[i]->pid, i});
+    std::sort(by_pid_.begin(), by_pid_.end());
+
+    std::vector<size_t>& pending = pending_;
+    pending.clear();
+    claim_sum_.assign(batch.size(), 0);
+    for (size_t k = 0; k < by_pid_.size(); k++) {
+        if (k > 0 && by_pid_[k].first == by_pid_[k - 1].first) continue;
+        size_t i = by_pid_[k].second;
+        const Process& p = *batch[i];
+        claim_sum_[i] = std::accumulate(p.max_need.begin(), p.max_need.end(), 0LL);
+        pending.push_back(i);
+    }
+    std::vector<bool> candidate(batch.size(), false);
+    for (size_t i : pending) candidate[i] = true;
+
+    // Smallest claims first => most admissions per batch; ties keep batch order
+    std::sort(pending.begin(), pending.end(), [&](size_t a, size_t b) {
+        return claim_sum_[a] != claim_sum_[b] ? claim_sum_[a] < claim_sum_[b] : a < b;
+    });
+
+    std::vector<size_t>& granted_idx = granted_idx_;
+    std::vector<int>& seq = batch_seq_;
+    while (!pending.empty()) {
+        // Grant every candidate that fits. Ones that do not fit are left
+        // pending: after a rollback below they may fit again.
+        size_t base = batch_.size();
+        granted_idx.clear();
+        for (size_t i : pending) {
+            if (!batch_item_fits(*batch[i])) continue;
+            granted_idx.push_back(i);
+            batch_.push_back({batch[i], 0, false});
+            batch_grant_.resize(batch_.size() * m_);
+            grant_batch_item(batch_.size() - 1);
+        }
+        if (granted_idx.empty()) break;
+
+        if (safety_check(seq)) {
+            for (size_t i : granted_idx) out.admitted[i] = true;
+            out.safe_sequence = seq;
+            checked = true;
+            break;
+        }
+
+        // Largest safe prefix: lo is known safe, hi is known unsafe
+        size_t lo = 0, hi = granted_idx.size(), granted = hi;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            while (granted > mid) revoke_batch_item(base + --granted);
+            while (granted < mid) grant_batch_item(base + granted++);
+            if (safety_check(seq)) {
+                lo = mid;
+                out.safe_sequence = seq;
+                checked = true;
+            } else {
+                hi = mid;
+            }
+        }
+        while (granted > lo) revoke_batch_item(base + --granted);
+        while (granted < lo) grant_batch_item(base + granted++);
+        batch_.resize(base + lo);
+
+        for (size_t k = 0; k < lo; k++) out.admitted[granted_idx[k]] = true;
+        size_t bad = granted_idx[lo];
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [&](size_t i) {
+            return out.admitted[i] || i == bad;
+        }), pending.end());
+    }
+    batch_.clear();
+    // The last successful check saw the final state: revoking back to the safe
+    // prefix restores it, and every candidate's claim is set by the first
+    // round, before any check. Without one, either nothing was granted or the
+    // state was unsafe from the start (granting full needs keeps a safe state
+    // safe, so the first check passes); the cached order is right either way.
+    if (checked) remember_order(out.safe_sequence);
+    else order_valid_ = cached;
+
+    // Whatever was not admitted keeps its claim registered, as with request_resources
+    for (size_t i = 0; i < batch.size(); i++) {
+        const Process& p = *batch[i];
+        if (!candidate[i] || out.admitted[i]) continue;
+        bool fresh = !row_of_.contains(p.pid);
+        size_t r = row_for(p.pid);
+        bool same_claim = !fresh && std::equal(p.max_need.begin(), p.max_need.end(), max_row(r));
+        std::copy(p.max_need.begin(), p.max_need.end(), max_row(r));
+        for (size_t j = 0; j < m_; j++) need_row(r)[j] = max_row(r)[j] - alloc_row(r)[j];
+        // As in admit(): a new claim that fits the total can finish last
+        if (fresh && order_valid_ && leq(max_row(r), total_.data(), m_)) order_push_back(r);
+        else if (!same_claim) order_valid_ = false;
+    }
+
+    return out;
 }
 
 void Bankers::release_all(int pid) {
-    auto it = allocation_.find(pid);
-    if (it == allocation_.end()) return;
-    available_ = add(available_, it->second);
-    allocation_.erase(pid);
-    max_need_.erase(pid);
+    size_t r = row_of_.find(pid);
+    if (r == PidRowMap::npos) return;
+    add_to(available_.data(), alloc_row(r), m_);
+    row_of_.erase(pid);
+    erase_row(r);
+    // Dropping a row never makes a safe order unsafe (its entry goes stale)
+    if (order_valid_) compact_order();
+}
+
+void Bankers::advance_resource(const std::vector<int>& demand, size_t j) const {
+    size_t n = pids_.size();
+    const size_t* order = &order_[j * n];
+    size_t& c = cursor_[j];
+    while (c < n && demand[order[c] * m_ + j] <= work_[j]) {
+        size_t r = order[c++];
+        if (++fits_[r] == static_cast<int>(m_)) runnable_.push_back(r);
+    }
 }
 
 bool Bankers::safety_check(std::vector<int>& out_finish_order) const {
+    ScopedLatency latency(Probe::SafetyCheck);
+    return reduce(need_, out_finish_order);
+}
+
+// Instead of rescanning every process per pass, keep for each resource the
+// rows sorted by demand on that resource plus a cursor into that order. A row
+// becomes runnable once all m cursors have moved past it. Finishing a row
+// only grows work on the resources it held, so only those cursors advance.
+// Cost: O(n*m*log n) for the sorts, O(n*m) for the sweep.
+bool Bankers::reduce(const std::vector<int>& demand, std::vector<int>& out_finish_order) const {
     out_finish_order.clear();
-    std::vector<int> work = available_;
-
-    // finish flags for all processes in allocation_
-    std::unordered_map<int, bool> finish;
-    for (const auto& kv : allocation_) finish[kv.first] = false;
-
-    bool progress = true;
-    while (progress) {
-        progress = false;
-
-        for (const auto& kv : allocation_) {
-            int pid = kv.first;
-            if (finish[pid]) continue;
-
-            auto alloc = kv.second;
-            auto maxc = max_need_.at(pid);
-            auto need = sub(maxc, alloc);
-
-            if (leq(need, work)) {
-                // pretend pid finishes and releases
-                work = add(work, alloc);
-                finish[pid] = true;
-                out_finish_order.push_back(pid);
-                progress = true;
-            }
-        }
+    size_t n = pids_.size();
+    if (n == 0) return true;
+
+    std::copy(available_.begin(), available_.end(), work_.begin());
+    fits_.assign(n, 0);
+    order_.resize(n * m_);
+    runnable_.clear();
+    runnable_.reserve(n);
+    out_finish_order.reserve(n);
+
+    for (size_t j = 0; j < m_; j++) {
+        size_t* order = &order_[j * n];
+        for (size_t r = 0; r < n; r++) order[r] = r;
+        std::sort(order, order + n, [&](size_t a, size_t b) {
+            return demand[a * m_ + j] < demand[b * m_ + j];
+        });
+        cursor_[j] = 0;
+        advance_resource(demand, j);
+    }
+
+    // runnable_ doubles as a FIFO: rows are appended as they fit and consumed in order
+    for (size_t next = 0; next < runnable_.size(); next++) {
+        size_t r = runnable_[next];
+        // pretend r finishes and releases
+        const int* alloc = alloc_row(r);
+        add_to(work_.data(), alloc, m_);
+        out_finish_order.push_back(pids_[r]);
+
+        for (size_t j = 0; j < m_; j++)
+            if (alloc[j] > 0) advance_resource(demand, j);
     }
 
     // If any process not finished => unsafe
-    for (const auto& kv : finish) {
-        if (!kv.second) return false;
+    return out_finish_order.size() == n;
+}
+
+// ---------------- optimistic admission ----------------
+
+void Bankers::sync_from(const Bankers& o) {
+    if (o.m_ != m_) throw std::invalid_argument("sync_from: resource count differs");
+    available_ = o.available_;
+    total_ = o.total_;
+    pids_ = o.pids_;
+    order_pos_.assign(pids_.size(), 0);
+    row_of_ = o.row_of_;
+    allocation_ = o.allocation_;
+    max_need_ = o.max_need_;
+    need_ = o.need_;
+    pending_req_ = o.pending_req_;
+    order_valid_ = false;
+}
+
+void Bankers::sync_rows_from(const Bankers& o, const std::vector<int>& pids) {
+    if (o.m_ != m_) throw std::invalid_argument("sync_rows_from: resource count differs");
+    available_ = o.available_;
+    for (int pid : pids) {
+        size_t src = o.row_of_.find(pid);
+        if (src == PidRowMap::npos) {
+            size_t r = row_of_.find(pid);
+            if (r == PidRowMap::npos) continue;
+            row_of_.erase(pid);
+            erase_row(r);
+            continue;
+        }
+        size_t r = row_for(pid);
+        std::copy_n(o.alloc_row(src), m_, alloc_row(r));
+        std::copy_n(&o.max_need_[src * m_], m_, max_row(r));
+        std::copy_n(o.need_row(src), m_, need_row(r));
+        std::copy_n(&o.pending_req_[src * m_], m_, pending_row(r));
+    }
+    order_valid_ = false;
+}
+
+bool Bankers::apply_admission(const std::vector<const Process*>& batch, const BatchAdmission& decided,
+                              bool exact) {
+    // Same candidates as request_batch: right width, first entry of a pid
+    by_pid_.clear();
+    for (size_t i = 0; i < batch.size(); i++)
+        if (batch[i]->max_need.size() == m_) by_pid_.push_back({batch[i]->pid, i});
+    std::sort(by_pid_.begin(), by_pid_.end());
+    pending_.clear();
+    for (size_t k = 0; k < by_pid_.size(); k++)
+        if (k == 0 || by_pid_[k].first != by_pid_[k - 1].first) pending_.push_back(by_pid_[k].second);
+
+    order_valid_ = false;
+    if (!exact) {
+        std::copy(available_.begin(), available_.end(), work_.begin());
+        for (size_t i : pending_) {
+            const Process& p = *batch[i];
+            if (row_of_.contains(p.pid)) return false;
+            if (!decided.admitted[i]) continue;
+            if (!leq(p.max_need.data(), work_.data(), m_)) return false;
+            sub_from(work_.data(), p.max_need.data(), m_);
+        }
+    }
+
+    for (size_t i : pending_) {
+        const Process& p = *batch[i];
+        size_t r = row_for(p.pid);
+        std::copy(p.max_need.begin(), p.max_need.end(), max_row(r));
+        for (size_t j = 0; j < m_; j++) need_row(r)[j] = max_row(r)[j] - alloc_row(r)[j];
+        if (!decided.admitted[i]) continue;
+        sub_from(available_.data(), need_row(r), m_);
+        add_to(alloc_row(r), need_row(r), m_);
+        std::fill_n(need_row(r), m_, 0);
     }
     return true;
 }
+
+// ---------------- checkpoints ----------------
+
+BankerImage Bankers::image() const {
+    BankerImage img;
+    img.m = m_;
+    img.n = pids_.size();
+    img.available = available_.data();
+    img.total = total_.data();
+    img.pids = pids_.data();
+    img.allocation = allocation_.data();
+    img.max_need = max_need_.data();
+    img.need = need_.data();
+    img.pending = pending_req_.data();
+    img.mode = mode_;
+    img.detect_every = detect_every_;
+    return img;
+}
+
+void Bankers::load_image(const BankerImage& img) {
+    if (img.m != m_) throw std::invalid_argument("load_image: resource count differs");
+    size_t cells = img.n * m_;
+
+    // Only states that grants and releases can reach: every cell in range,
+    // need = max - allocation, and nothing created or lost overall
+    std::vector<long long> held(img.available, img.available + m_);
+    for (size_t j = 0; j < m_; j++)
+        if (img.available[j] < 0) throw std::invalid_argument("load_image: negative available");
+    for (size_t c = 0; c < cells; c++) {
+        long long alloc = img.allocation[c], max = img.max_need[c];
+        if (alloc < 0 || alloc > max || img.need[c] != max - alloc || img.pending[c] < 0 ||
+            img.pending[c] > img.need[c])
+            throw std::invalid_argument("load_image: inconsistent row for pid " + std::to_string(img.pids[c / m_]));
+        held[c % m_] += alloc;
+    }
+    for (size_t j = 0; j < m_; j++)
+        if (held[j] != img.total[j])
+            throw std::invalid_argument("load_image: available + allocation differs from total");
+
+    PidRowMap row_of;
+    row_of.reserve(img.n);
+    for (size_t r = 0; r < img.n; r++) {
+        if (row_of.contains(img.pids[r])) throw std::invalid_argument("load_image: pid repeats");
+        row_of.insert_or_assign(img.pids[r], r);
+    }
+
+    row_of_ = std::move(row_of);
+    available_.assign(img.available, img.available + m_);
+    total_.assign(img.total, img.total + m_);
+    pids_.assign(img.pids, img.pids + img.n);
+    order_pos_.assign(img.n, 0);
+    allocation_.assign(img.allocation, img.allocation + cells);
+    max_need_.assign(img.max_need, img.max_need + cells);
+    need_.assign(img.need, img.need + cells);
+    pending_req_.assign(img.pending, img.pending + cells);
+    mode_ = img.mode;
+    detect_every_ = img.detect_every;
+    since_detect_ = 0;
+    aborted_.clear();
+    order_valid_ = false;
+}
+
+// ---------------- incremental requests ----------------
+
+size_t Bankers::checked_row(int pid, const ResourceVector& v, const char* what) const {
+    if (v.size() != m_)
+        throw std::invalid_argument(std::string(what) + ": width differs from resource count");
+    for (int x : v)
+        if (x < 0) throw std::invalid_argument(std::string(what) + ": negative amount");
+    size_t r = row_of_.find(pid);
+    if (r == PidRowMap::npos)
+        throw std::invalid_argument(std::string(what) + ": pid " + std::to_string(pid) + " has no claim");
+    return r;
+}
+
+void Bankers::declare(int pid, const ResourceVector& max_claim) {
+    if (max_claim.size() != m_) throw std::invalid_argument("declare: width differs from resource count");
+    size_t existing = row_of_.find(pid);
+    if (existing != PidRowMap::npos && !leq(alloc_row(existing), max_claim.data(), m_))
+        throw std::invalid_argument("declare: claim below current allocation of pid " + std::to_string(pid));
+
+    size_t r = row_for(pid);
+    bool same_claim = existing != PidRowMap::npos && std::equal(max_claim.begin(), max_claim.end(), max_row(r));
+    std::copy(max_claim.begin(), max_claim.end(), max_row(r));
+    for (size_t j = 0; j < m_; j++) need_row(r)[j] = max_row(r)[j] - alloc_row(r)[j];
+    std::fill_n(pending_row(r), m_, 0);
+    if (existing == PidRowMap::npos && order_valid_ && leq(max_claim.data(), total_.data(), m_))
+        order_push_back(r);
+    else if (!same_claim) order_valid_ = false;
+}
+
+Grant Bankers::request(int pid, const ResourceVector& delta) {
+    ScopedLatency latency(Probe::RequestResources);
+    size_t r = checked_row(pid, delta, "request");
+    if (!leq(delta.data(), need_row(r), m_))
+        throw std::invalid_argument("request: pid " + std::to_string(pid) + " exceeds its claim");
+
+    if (!leq(delta.data(), available_.data(), m_)) {
+        if (mode_ == BankerMode::Detection) {
+            std::copy(delta.begin(), delta.end(), pending_row(r));
+            maybe_detect();
+        }
+        return Grant::Unavailable;
+    }
+
+    sub_from(available_.data(), delta.data(), m_);
+    add_to(alloc_row(r), delta.data(), m_);
+    sub_from(need_row(r), delta.data(), m_);
+
+    if (mode_ == BankerMode::Avoidance) {
+        if (order_valid_ && reorder_after_grant(r)) return Grant::Granted;
+        std::vector<int>& seq = batch_seq_;
+        if (!safety_check(seq)) {
+            add_to(available_.data(), delta.data(), m_);
+            sub_from(alloc_row(r), delta.data(), m_);
+            add_to(need_row(r), delta.data(), m_);
+            return Grant::Unsafe;
+        }
+        remember_order(seq);
+        return Grant::Granted;
+    }
+
+    order_valid_ = false;
+    std::fill_n(pending_row(r), m_, 0);
+    maybe_detect();
+    return Grant::Granted;
+}
+
+void Bankers::release(int pid, const ResourceVector& delta) {
+    size_t r = checked_row(pid, delta, "release");
+    if (!leq(delta.data(), alloc_row(r), m_))
+        throw std::invalid_argument("release: pid " + std::to_string(pid) + " does not hold that much");
+
+    // Work before r grows by delta as much as r's need does: the order stays safe
+    add_to(available_.data(), delta.data(), m_);
+    sub_from(alloc_row(r), delta.data(), m_);
+    add_to(need_row(r), delta.data(), m_);
+}
+
+std::vector<int> Bankers::allocation_of(int pid) const {
+    size_t r = row_of_.find(pid);
+    if (r == PidRowMap::npos) return std::vector<int>(m_, 0);
+    return std::vector<int>(alloc_row(r), alloc_row(r) + m_);
+}
+
+std::vector<int> Bankers::need_of(int pid) const {
+    size_t r = row_of_.find(pid);
+    if (r == PidRowMap::npos) return std::vector<int>(m_, 0);
+    return std::vector<int>(need_row(r), need_row(r) + m_);
+}
+
+// ---------------- detection and recovery ----------------
+
+void Bankers::set_mode(BankerMode mode, size_t detect_every) {
+    mode_ = mode;
+    detect_every_ = detect_every;
+    since_detect_ = 0;
+    // Pending requests are only tracked in detection mode
+    std::fill(pending_req_.begin(), pending_req_.end(), 0);
+}
+
+void Bankers::maybe_detect() {
+    if (detect_every_ == 0 || ++since_detect_ < detect_every_) return;
+    since_detect_ = 0;
+    std::vector<int> victims = recover();
+    aborted_.insert(aborted_.end(), victims.begin(), victims.end());
+}
+
+// Same reduction as the safety check, but a row only has to get its pending
+// request (not its whole remaining claim) to be able to finish. Rows holding
+// nothing cannot block anyone and are never reported.
+std::vector<int> Bankers::detect_deadlock() const {
+    ScopedLatency latency(Probe::DeadlockDetect);
+    std::vector<int> finished;
+    std::vector<int> deadlocked;
+    if (reduce(pending_req_, finished)) return deadlocked;
+
+    std::vector<char> done(pids_.size(), 0);
+    for (int pid : finished) done[row_of_.find(pid)] = 1;
+    for (size_t r = 0; r < pids_.size(); r++) {
+        if (done[r]) continue;
+        const int* alloc = alloc_row(r);
+        if (std::any_of(alloc, alloc + m_, [](int x) { return x > 0; })) deadlocked.push_back(pids_[r]);
+    }
+    std::sort(deadlocked.begin(), deadlocked.end());
+    return deadlocked;
+}
+
+std::vector<int> Bankers::recover() {
+    std::vector<int> victims;
+    for (std::vector<int> dl = detect_deadlock(); !dl.empty(); dl = detect_deadlock()) {
+        // Abort the process holding the most units: frees the most per victim
+        int victim = dl.front();
+        long long most = -1;
+        for (int pid : dl) {
+            const int* alloc = alloc_row(row_of_.find(pid));
+            long long held = std::accumulate(alloc, alloc + m_, 0LL);
+            if (held > most) {
+                most = held;
+                victim = pid;
+            }
+        }
+        release_all(victim);
+        victims.push_back(victim);
+    }
+    return victims;
+}
@@ -1,8 +1,43 @@
 #pragma once
+#include <deque>
 #include <vector>
-#include <unordered_map>
 #include <optional>
+#include <utility>
+#include "pid_map.hpp"
 #include "process.hpp"
+#include "resource_kernels.hpp"
+
+// How request() treats a grant that fits into what is available:
+//   Avoidance - grant only if the state stays safe (Banker's algorithm)
+//   Detection - grant immediately; every detect_every requests the
+//               detection algorithm runs and deadlocked processes are aborted
+enum class BankerMode { Avoidance, Detection };
+
+enum class Grant {
+    Granted,
+    Unavailable,   // delta exceeds what is available now; retry later
+    Unsafe,        // avoidance only: granting would leave an unsafe state
+};
+
+struct BatchAdmission {
+    std::vector<bool> admitted;      // per batch index
+    std::vector<int> safe_sequence;  // safe sequence of the final state (empty if none admitted)
+};
+
+// Flat view of a banker's state (row-major n x m matrices), used to save
+// and restore it without walking rows
+struct BankerImage {
+    size_t m{0}, n{0};
+    const int* available{nullptr};    // m
+    const int* total{nullptr};        // m
+    const int* pids{nullptr};         // n
+    const int* allocation{nullptr};   // n x m
+    const int* max_need{nullptr};     // n x m
+    const int* need{nullptr};         // n x m
+    const int* pending{nullptr};      // n x m
+    BankerMode mode{BankerMode::Avoidance};
+    size_t detect_every{64};
+};
 
 class Bankers {
 public:
@@ -10,24 +45,189 @@ public:
 
     // Try to grant "request" to pid. If safe => grant + return safe sequence.
     // If unsafe => do NOT change state and return nullopt.
-    std::optional<std::vector<int>> request_resources(int pid,
-                                                      const std::vector<int>& max_claim);
+    // While the last safe sequence is still known, granting a full claim that
+    // fits is safe without a new check (pid can finish first); the returned
+    // sequence is then that one with pid moved to the front.
+    std::optional<std::vector<int>> request_resources(int pid, const int* max_claim, size_t m);
+    std::optional<std::vector<int>> request_resources(int pid, const std::vector<int>& max_claim) {
+        return request_resources(pid, max_claim.data(), max_claim.size());
+    }
+    std::optional<std::vector<int>> request_resources(int pid, const ResourceVector& max_claim) {
+        return request_resources(pid, max_claim.data(), max_claim.size());
+    }
+    // Same decision and state change, without building the sequence: O(m)
+    // while the last safe sequence is known
+    bool admit(int pid, const int* max_claim, size_t m);
+    bool admit(int pid, const ResourceVector& max_claim) {
+        return admit(pid, max_claim.data(), max_claim.size());
+    }
+    // A safe sequence of the current state: the cached one while it is
+    // known, otherwise from a full check. Empty if the state is unsafe.
+    std::vector<int> safe_sequence() const;
+
+    // Admit the largest safe subset of a batch (greedy, smallest claims first).
+    // Candidates are granted together and checked once; only when that fails
+    // is the admitted prefix binary-searched. Afterwards the state is the same
+    // as calling request_resources for each process in the chosen order
+    // (rejected processes keep their registered claim).
+    BatchAdmission request_batch(const std::vector<Process>& batch);
+    // Same, over records owned elsewhere (e.g. a ProcessPool)
+    BatchAdmission request_batch(const std::vector<const Process*>& batch);
 
     // Release all resources of pid (when process finishes)
     void release_all(int pid);
 
+    // ---- Incremental requests ----
+    // Registers (or changes) pid's maximum claim without allocating anything.
+    // Throws invalid_argument if the width is wrong or the claim is below
+    // what pid already holds.
+    void declare(int pid, const ResourceVector& max_claim);
+    // Asks for delta more of each resource, within the declared claim.
+    // Nothing changes unless the result is Granted. Throws invalid_argument
+    // for an undeclared pid, a negative delta, or one that exceeds the claim.
+    Grant request(int pid, const ResourceVector& delta);
+    // Gives back part of what pid holds; throws invalid_argument if delta
+    // is negative or more than the allocation
+    void release(int pid, const ResourceVector& delta);
+
+    // ---- Detection and recovery ----
+    void set_mode(BankerMode mode, size_t detect_every = 64);
+    BankerMode mode() const { return mode_; }
+    // Processes that hold resources and can never get their pending request,
+    // whatever the others do (detection algorithm on the pending requests)
+    std::vector<int> detect_deadlock() const;
+    // Aborts deadlocked processes (most resources held first) until none is
+    // left; returns the victims, whose rows are gone as after release_all
+    std::vector<int> recover();
+    // Victims of the periodic detection since the last call
+    std::vector<int> take_aborted() { return std::exchange(aborted_, {}); }
+
+    // ---- Optimistic admission (see admission.hpp) ----
+    // Copies the allocation state of o, which must have the same resources
+    void sync_from(const Bankers& o);
+    // Same, when only the rows of `pids` (and available) can differ: each
+    // row is copied from o, or dropped if o has none. O(pids * m).
+    void sync_rows_from(const Bankers& o, const std::vector<int>& pids);
+    // Applies a request_batch decision that was computed on a copy of this
+    // state. exact: nothing changed here since the copy was taken. Otherwise
+    // the decision is validated first (every pid new here, admitted claims
+    // fit what is available now); on failure nothing changes and false is
+    // returned. A grant of a whole remaining need that fits keeps a safe
+    // state safe, since that process can finish first.
+    bool apply_admission(const std::vector<const Process*>& batch, const BatchAdmission& decided,
+                         bool exact);
+    // Initial resources (available + all allocations)
+    const std::vector<int>& total() const { return total_; }
+
+    // ---- Checkpoints ----
+    // Valid until the next change to this banker
+    BankerImage image() const;
+    // Replaces the whole state with a copy of img. Throws invalid_argument,
+    // changing nothing, if img.m differs, a pid repeats, a cell is negative,
+    // need != max - allocation, a pending request exceeds the need, or
+    // available + allocations != total.
+    void load_image(const BankerImage& img);
+
+    // Per-pid view (all zero for an unknown pid)
+    std::vector<int> allocation_of(int pid) const;
+    std::vector<int> need_of(int pid) const;
+
     const std::vector<int>& available() const { return available_; }
+    size_t resource_count() const { return m_; }
+    const ResourceKernels& kernels() const { return kernels_; }
+    size_t process_count() const { return pids_.size(); }
 
 private:
+    size_t m_;                  // number of resource types
     std::vector<int> available_;
-    // allocation[pid] = currently allocated resources to pid
-    std::unordered_map<int, std::vector<int>> allocation_;
-    // max_need[pid] = maximum claim for pid
-    std::unordered_map<int, std::vector<int>> max_need_;
+    std::vector<int> total_;
+
+    // Dense n x m matrices (row-major), one row per known pid.
+    // Rows are removed by swapping in the last row, so they stay contiguous.
+    std::vector<int> pids_;                  // row -> pid
+    PidRowMap row_of_;                       // pid -> row
+    std::vector<int> allocation_;            // currently allocated resources
+    std::vector<int> max_need_;              // maximum claim
+    std::vector<int> need_;                  // max_need - allocation (kept in sync)
+    std::vector<int> pending_req_;           // detection mode: last request that did not fit
+
+    BankerMode mode_{BankerMode::Avoidance};
+    size_t detect_every_{64};
+    size_t since_detect_{0};
+    std::vector<int> aborted_;
+
+    // Scratch space for safety_check (reused so the check does not allocate)
+    mutable std::vector<int> work_;
+    mutable std::vector<int> fits_;      // per row: #resources whose need fits work
+    mutable std::vector<size_t> order_;  // per resource: rows sorted by need
+    mutable std::vector<size_t> cursor_; // per resource: next row in order_ to test
+    mutable std::vector<size_t> runnable_;
+    std::vector<int> grant_;             // amount granted by the pending request
+
+    // A safe sequence of the current state, only meaningful while
+    // order_valid_. Kept up to date in the cheap cases (full-claim grants,
+    // releases, new claims that fit the total) and dropped by anything else.
+    // safe_order_[k] sits at position order_front_ + k, and order_pos_ holds
+    // each row's position. An entry whose pid has no row, or whose row sits
+    // elsewhere, is stale: moving or dropping a pid is O(1), and stale
+    // entries are skipped until compact_order() sweeps them out.
+    std::deque<int> safe_order_;
+    std::vector<long long> order_pos_;   // per row
+    long long order_front_{0};
+    std::vector<int> reorder_;           // scratch for request()
+    bool order_valid_{true};             // an empty state is safe
+
+    // request_batch candidates currently granted, in grant order
+    struct BatchGrant {
+        const Process* proc;
+        size_t row;
+        bool fresh;                      // row was created by the grant
+    };
+    std::vector<BatchGrant> batch_;
+    std::vector<int> batch_grant_;       // need granted to each candidate (k x m)
+
+    // request_batch scratch, reused so steady-state batches do not allocate
+    std::vector<const Process*> batch_procs_;
+    std::vector<size_t> pending_;
+    std::vector<size_t> granted_idx_;
+    std::vector<long long> claim_sum_;
+    std::vector<std::pair<int, size_t>> by_pid_;  // (pid, index) for duplicate detection
+    std::vector<int> batch_seq_;
+
+    size_t row_for(int pid);
+    void erase_row(size_t row);
+    bool batch_item_fits(const Process& p) const;
+    void grant_batch_item(size_t i);
+    void revoke_batch_item(size_t i);
+
+    int* alloc_row(size_t r) { return &allocation_[r * m_]; }
+    int* max_row(size_t r) { return &max_need_[r * m_]; }
+    int* need_row(size_t r) { return &need_[r * m_]; }
+    int* pending_row(size_t r) { return &pending_req_[r * m_]; }
+    const int* alloc_row(size_t r) const { return &allocation_[r * m_]; }
+    const int* need_row(size_t r) const { return &need_[r * m_]; }
 
     bool safety_check(std::vector<int>& out_finish_order) const;
+    // Lets every row whose demand fits finish and return its allocation.
+    // Finish order goes to out; true if every row finished.
+    bool reduce(const std::vector<int>& demand, std::vector<int>& out_finish_order) const;
+    // Move every row whose demand on resource j now fits work[j] past cursor j
+    void advance_resource(const std::vector<int>& demand, size_t j) const;
+    size_t checked_row(int pid, const ResourceVector& v, const char* what) const;
+    void remember_order(const std::vector<int>& finish_order);
+    bool order_live(size_t k) const;
+    void order_push_front(size_t r);
+    void order_push_back(size_t r);
+    // Drops stale entries once they outnumber the live ones (amortized O(1))
+    void compact_order();
+    // After a partial grant to row r: re-validates the cached order with r
+    // moved to the earliest point it fits (one O(n*m) pass, no sorting)
+    bool reorder_after_grant(size_t r);
+    void maybe_detect();
 
-    static bool leq(const std::vector<int>& a, const std::vector<int>& b);
-    static std::vector<int> add(const std::vector<int>& a, const std::vector<int>& b);
-    static std::vector<int> sub(const std::vector<int>& a, const std::vector<int>& b);
+    // In-place kernels over m_-wide rows, chosen for m_ and the CPU at construction
+    ResourceKernels kernels_;
+    bool leq(const int* a, const int* b, size_t m) const { return kernels_.leq(a, b, m); }
+    void add_to(int* dst, const int* src, size_t m) const { kernels_.add(dst, src, m); }
+    void sub_from(int* dst, const int* src, size_t m) const { kernels_.sub(dst, src, m); }
 };
@@ -0,0 +1,515 @@
+#include "batch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "event_log.hpp"
+#include "paging.hpp"
+#include "simulator.hpp"
+#include "sweep.hpp"
+#include "trace.hpp"
+#include "workload.hpp"
+
+namespace {
+
+struct BatchOptions {
+    std::string trace;
+    std::string out;             // JSON summary ("" => stdout)
+    std::string per_process;     // optional CSV pid,waiting,turnaround,response
+    std::string convert_in, convert_out;
+    std::string workload;                       // generator spec, replaces --trace
+    std::string generate_spec, generate_out;    // write a generated trace
+    std::string events;                         // binary event log of the replay
+    std::string gantt;                          // columnar Gantt export
+    std::string checkpoint;                     // simulator snapshot after the run
+    int timeline{0};                            // ASCII timeline width, 0 = none
+    std::string events_in, events_out;          // offline conversion
+    bool events_chrome{false};
+    std::vector<int> available;
+    SchedPolicy policy{SchedPolicy::Auto};
+    std::string policy_name{"auto"};
+    int quantum{4};
+    int buffer{4096};
+    int dispatchers{1};
+    WakeupOrder wakeup{WakeupOrder::Fifo};
+    MultiCoreConfig multicore;   // used when --cores is given
+    bool metrics{false};         // add latency histograms to the summary
+    bool use_cores{false};
+    bool online{false};          // discrete-event run instead of phases
+
+    // --sweep: cartesian product policies x quanta x availables
+    bool sweep{false};
+    std::vector<SchedPolicy> policies;
+    std::vector<int> quanta;
+    std::vector<std::vector<int>> availables;
+    unsigned threads{0};
+
+    // --paging: replay a memory-reference trace per replacement policy x frame count
+    std::string paging;
+    std::string refs_spec, refs_out;            // write a generated reference trace
+    std::vector<Replacement> replacements;
+    std::vector<int> frames;
+    int tlb{64};
+};
+
+void usage(std::ostream& os) {
+    os << "usage:\n"
+          "  sim                                   interactive menu\n"
+          "  sim --trace FILE [options]            replay a workload trace\n"
+          "  sim --convert IN.csv OUT.trace        convert a CSV trace to binary\n"
+          "  sim --workload SPEC [options]         replay a generated workload\n"
+          "  sim --generate SPEC OUT.trace         write a generated workload as a binary trace\n"
+          "  sim --sweep --trace FILE [sweep opts] run a grid of configurations in parallel\n"
+          "  sim --events-to-text LOG OUT          convert a binary event log to text\n"
+          "  sim --events-to-chrome LOG OUT.json   convert a binary event log to Chrome trace JSON\n"
+          "  sim --paging REFS [paging opts]       replay a memory-reference trace per replacement policy\n"
+          "  sim --generate-refs SPEC OUT.refs     write a generated memory-reference trace\n"
+          "workload SPEC: key=value,.. with n, m, seed, arrivals=poisson|bursty, rate,\n"
+          "  group, factor, bursts=exp|pareto, mean-burst, alpha, max-burst,\n"
+          "  priorities=w1:w2:.., claims=c|c1:c2:.., correlation, slack,\n"
+          "  io (I/O requests per process, --online only), mean-io, devices\n"
+          "options:\n"
+          "  --available a,b,..   initial available vector (default 3,3,2 for m=3)\n"
+          "  --policy P           auto|priority|priority-preemptive|rr|rr-rounds|\n"
+          "                       srtf|mlfq|cfs|edf (default auto)\n"
+          "  --quantum N          round robin quantum (default 4)\n"
+          "  --buffer N           ready buffer capacity (default 4096)\n"
+          "  --dispatchers N      admission threads; N > 1 admits optimistically (default 1)\n"
+          "  --wakeup O           retry order of unblocked processes: fifo|smallest-need (default fifo)\n"
+          "  --out FILE           write the JSON summary to FILE instead of stdout\n"
+          "  --per-process FILE   write pid,waiting,turnaround,response CSV\n"
+          "  --metrics            include hot-path latency percentiles in the summary\n"
+          "  --events FILE        write a binary event log (push/pop/admit/block/unblock/slice)\n"
+          "  --gantt FILE         stream the Gantt chart to a columnar binary file\n"
+          "  --timeline W         print a W-column ASCII timeline of the schedule to stderr\n"
+          "  --checkpoint FILE    snapshot the simulator state after a phased run (menu option 7 restores it)\n"
+          "  --online             overlap intake, admission, running and release on one\n"
+          "                       simulated clock (policies auto|rr|priority; --cores N = N CPUs)\n"
+          "  --cores N            schedule on N CPUs (per-core round robin + work stealing)\n"
+          "  --migration-cost C   warm-up time after moving to a core of the same node (default 1)\n"
+          "  --remote-cost C      warm-up time after moving to another node (default 4)\n"
+          "  --cores-per-node K   cores per node (default: all cores in one node)\n"
+          "sweep options (output: CSV table, one row per configuration):\n"
+          "  --policies P,..      policies to try (default auto)\n"
+          "  --quanta N,..        quanta to try for rr policies (default 4)\n"
+          "  --availables V;..    available vectors, ';'-separated, or 'none' to skip admission\n"
+          "  --threads N          worker threads (default: one per core)\n"
+          "paging options (output: JSON, one result per policy and frame count; --threads, --out apply):\n"
+          "  --replacement P,..   fifo|lru|clock|arc (default all four)\n"
+          "  --frames N,..        physical frames shared by all processes (default 1024)\n"
+          "  --tlb N              TLB entries, 4-way sets, 0 = none (default 64)\n"
+          "refs SPEC: key=value,.. with n, seed, procs, pages, hot, hot-prob, phase,\n"
+          "  run, scan, repeat, life\n";
+}
+
+std::vector<int> parse_int_list(const std::string& s) {
+    std::vector<int> v;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) v.push_back(std::stoi(item));
+    if (v.empty()) throw std::invalid_argument("empty list");
+    return v;
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) parts.push_back(item);
+    if (parts.empty()) throw std::invalid_argument("empty list");
+    return parts;
+}
+
+BatchOptions parse_args(int argc, char** argv) {
+    BatchOptions o;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument(a + " needs a value");
+            return argv[++i];
+        };
+
+        if (a == "--trace") o.trace = value();
+        else if (a == "--out") o.out = value();
+        else if (a == "--per-process") o.per_process = value();
+        else if (a == "--metrics") o.metrics = true;
+        else if (a == "--online") o.online = true;
+        else if (a == "--events") o.events = value();
+        else if (a == "--gantt") o.gantt = value();
+        else if (a == "--checkpoint") o.checkpoint = value();
+        else if (a == "--timeline") o.timeline = std::stoi(value());
+        else if (a == "--events-to-text") { o.events_in = value(); o.events_out = value(); }
+        else if (a == "--events-to-chrome") { o.events_in = value(); o.events_out = value(); o.events_chrome = true; }
+        else if (a == "--available") o.available = parse_int_list(value());
+        else if (a == "--policy") { o.policy_name = value(); o.policy = Scheduler::parse_policy(o.policy_name); }
+        else if (a == "--quantum") o.quantum = std::stoi(value());
+        else if (a == "--buffer") o.buffer = std::stoi(value());
+        else if (a == "--dispatchers") o.dispatchers = std::stoi(value());
+        else if (a == "--wakeup") o.wakeup = parse_wakeup_order(value());
+        else if (a == "--convert") { o.convert_in = value(); o.convert_out = value(); }
+        else if (a == "--workload") o.workload = value();
+        else if (a == "--generate") { o.generate_spec = value(); o.generate_out = value(); }
+        else if (a == "--cores") { o.multicore.cores = std::stoi(value()); o.use_cores = true; }
+        else if (a == "--migration-cost") o.multicore.migration_cost = std::stoi(value());
+        else if (a == "--remote-cost") o.multicore.remote_cost = std::stoi(value());
+        else if (a == "--cores-per-node") o.multicore.cores_per_node = std::stoi(value());
+        else if (a == "--sweep") o.sweep = true;
+        else if (a == "--policies") {
+            for (auto& p : split(value(), ',')) o.policies.push_back(Scheduler::parse_policy(p));
+        }
+        else if (a == "--quanta") o.quanta = parse_int_list(value());
+        else if (a == "--availables") {
+            for (auto& v : split(value(), ';'))
+                o.availables.push_back(v == "none" ? std::vector<int>{} : parse_int_list(v));
+        }
+        else if (a == "--paging") o.paging = value();
+        else if (a == "--generate-refs") { o.refs_spec = value(); o.refs_out = value(); }
+        else if (a == "--replacement") {
+            for (const auto& name : split(value(), ',')) o.replacements.push_back(parse_replacement(name));
+        }
+        else if (a == "--frames") o.frames = parse_int_list(value());
+        else if (a == "--tlb") o.tlb = std::stoi(value());
+        else if (a == "--threads") o.threads = static_cast<unsigned>(std::stoi(value()));
+        else throw std::invalid_argument("unknown option " + a);
+    }
+    if (!o.trace.empty() && !o.workload.empty())
+        throw std::invalid_argument("--trace and --workload are exclusive");
+    if (o.quantum <= 0) throw std::invalid_argument("--quantum must be > 0");
+    if (o.buffer <= 0) throw std::invalid_argument("--buffer must be > 0");
+    if (o.dispatchers <= 0) throw std::invalid_argument("--dispatchers must be > 0");
+    if (o.use_cores && o.multicore.cores <= 0) throw std::invalid_argument("--cores must be > 0");
+    if (o.online && (o.sweep || o.dispatchers > 1))
+        throw std::invalid_argument("--online runs alone: no --sweep or --dispatchers");
+    if (o.online && (!o.per_process.empty() || o.metrics || !o.checkpoint.empty()))
+        throw std::invalid_argument("--per-process, --metrics and --checkpoint need a phased run (no --online)");
+    if (o.use_cores && (!o.gantt.empty() || o.timeline > 0))
+        throw std::invalid_argument("--gantt and --timeline need a single-CPU run");
+    if (o.timeline < 0) throw std::invalid_argument("--timeline must be > 0");
+    if (o.use_cores && o.policy != SchedPolicy::Auto && o.policy != SchedPolicy::RoundRobin &&
+        o.policy != SchedPolicy::RoundRobinRounds)
+        throw std::invalid_argument("--cores schedules round robin per core; use --policy rr");
+    for (int q : o.quanta)
+        if (q <= 0) throw std::invalid_argument("--quanta must be > 0");
+    for (int f : o.frames)
+        if (f <= 0) throw std::invalid_argument("--frames must be > 0");
+    if (o.tlb < 0) throw std::invalid_argument("--tlb must be >= 0");
+    return o;
+}
+
+std::string json_escape(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r;
+}
+
+// ,"name":{"mean":..,"stddev":..,"p50":..,"p95":..,"p99":..,"max":..}
+void write_stat(std::ostream& os, const char* name, const StreamingStat& s) {
+    os << ",\"" << name << "\":{\"mean\":" << s.mean()
+       << ",\"stddev\":" << s.stddev()
+       << ",\"p50\":" << s.percentile(0.50)
+       << ",\"p95\":" << s.percentile(0.95)
+       << ",\"p99\":" << s.percentile(0.99)
+       << ",\"max\":" << s.max() << "}";
+}
+
+void write_summary(std::ostream& os, const BatchOptions& o, size_t m, const RunReport& r,
+                   const MetricsSnapshot& metrics) {
+    size_t gantt_entries = r.schedule.gantt.size() + r.schedule.rounds.size();
+    for (const auto& c : r.multicore.cores) gantt_entries += c.gantt.size();
+
+    if (o.workload.empty()) os << "{\"trace\":\"" << json_escape(o.trace) << "\"";
+    else os << "{\"workload\":\"" << json_escape(o.workload) << "\"";
+    os << ",\"resources\":" << m
+       << ",\"policy\":\"" << o.policy_name << "\""
+       << ",\"quantum\":" << o.quantum
+       << ",\"processes\":" << r.processes
+       << ",\"admitted\":" << r.admitted
+       << ",\"blocked\":" << r.blocked
+       << ",\"unblocked\":" << r.unblocked
+       << ",\"avg_waiting\":" << r.schedule.avg_waiting
+       << ",\"avg_turnaround\":" << r.schedule.avg_turnaround
+       << ",\"makespan\":" << r.schedule.finish_time
+       << ",\"deadline_misses\":" << r.schedule.deadline_misses
+       << ",\"gantt_entries\":" << gantt_entries;
+    write_stat(os, "waiting", r.schedule.stats.waiting);
+    write_stat(os, "turnaround", r.schedule.stats.turnaround);
+    write_stat(os, "response", r.schedule.stats.response);
+    if (o.use_cores) {
+        os << ",\"cores\":" << r.multicore.cores.size()
+           << ",\"steals\":" << r.multicore.steals
+           << ",\"migrations\":" << r.multicore.migrations
+           << ",\"core_utilization\":[";
+        for (size_t c = 0; c < r.multicore.cores.size(); c++)
+            os << (c ? "," : "") << r.multicore.cores[c].utilization;
+        os << "]";
+    }
+    if (o.metrics) {
+        os << ",\"metrics\":{";
+        for (size_t i = 0; i < metrics.probes.size(); i++) {
+            const ProbeSummary& p = metrics.probes[i];
+            os << (i ? "," : "") << "\"" << p.name << "\":{\"count\":" << p.count
+               << ",\"mean_ns\":" << p.mean_ns << ",\"p50_ns\":" << p.p50_ns
+               << ",\"p99_ns\":" << p.p99_ns << ",\"p999_ns\":" << p.p999_ns
+               << ",\"max_ns\":" << p.max_ns << "}";
+        }
+        os << "}";
+    }
+    if (r.dispatchers > 1)
+        os << ",\"dispatchers\":" << r.dispatchers
+           << ",\"admission_conflicts\":" << r.admission_conflicts;
+    os << ",\"intake_ms\":" << r.intake_ms
+       << ",\"schedule_ms\":" << r.schedule_ms
+       << "}\n";
+}
+
+void write_online_summary(std::ostream& os, const BatchOptions& o, size_t m, const OnlineReport& r) {
+    if (o.workload.empty()) os << "{\"trace\":\"" << json_escape(o.trace) << "\"";
+    else os << "{\"workload\":\"" << json_escape(o.workload) << "\"";
+    os << ",\"mode\":\"online\""
+       << ",\"resources\":" << m
+       << ",\"policy\":\"" << o.policy_name << "\""
+       << ",\"quantum\":" << o.quantum
+       << ",\"cpus\":" << (o.use_cores ? o.multicore.cores : 1)
+       << ",\"processes\":" << r.processes
+       << ",\"completed\":" << r.completed
+       << ",\"blocked\":" << r.blocked
+       << ",\"unblocked\":" << r.unblocked
+       << ",\"stranded\":" << r.stranded
+       << ",\"avg_waiting\":" << r.avg_waiting
+       << ",\"avg_turnaround\":" << r.avg_turnaround
+       << ",\"max_turnaround\":" << r.max_turnaround
+       << ",\"avg_admission_delay\":" << r.avg_admission_delay
+       << ",\"max_admission_delay\":" << r.max_admission_delay
+       << ",\"makespan\":" << r.makespan
+       << ",\"deadline_misses\":" << r.deadline_misses
+       << ",\"io_requests\":" << r.io_requests
+       << ",\"avg_io_wait\":" << r.avg_io_wait
+       << ",\"max_io_queue\":" << r.max_io_queue
+       << ",\"events\":" << r.events
+       << ",\"wall_ms\":" << r.wall_ms
+       << "}\n";
+}
+
+void write_per_process(const std::string& path, const ScheduleResult& res) {
+    std::ofstream f(path);
+    if (!f) throw std::runtime_error("cannot create " + path);
+
+    f << "pid,waiting,turnaround,response\n";
+    for (const ProcessTimes& t : res.per_process)
+        f << t.pid << "," << t.waiting << "," << t.turnaround << "," << t.response << "\n";
+}
+
+// The trace, or a generator when --workload is given
+std::unique_ptr<TraceSource> open_source(const BatchOptions& o) {
+    if (!o.workload.empty()) return std::make_unique<WorkloadGenerator>(parse_workload_spec(o.workload));
+    return open_trace(o.trace);
+}
+
+int run_sweep_cli(BatchOptions& o) {
+    // One immutable in-memory copy shared by every configuration
+    auto src = open_source(o);
+    size_t m = src->resources();
+    auto workload = std::make_shared<std::vector<Process>>();
+    Process p;
+    while (src->next(p)) workload->push_back(p);
+
+    if (o.policies.empty()) o.policies = {SchedPolicy::Auto};
+    if (o.quanta.empty()) o.quanta = {o.quantum};
+    if (o.availables.empty()) o.availables = {o.available};
+
+    std::vector<SweepConfig> grid;
+    for (SchedPolicy policy : o.policies) {
+        for (size_t qi = 0; qi < (Scheduler::uses_quantum(policy) ? o.quanta.size() : 1); qi++) {
+            for (const auto& avail : o.availables) {
+                if (!avail.empty() && avail.size() != m)
+                    throw std::invalid_argument("available vector width differs from trace width " +
+                                                std::to_string(m));
+                grid.push_back({policy, o.quanta[qi], avail});
+            }
+        }
+    }
+
+    auto rows = run_sweep(std::shared_ptr<const std::vector<Process>>(workload), grid, o.threads);
+
+    std::ofstream file;
+    if (!o.out.empty()) {
+        file.open(o.out);
+        if (!file) throw std::runtime_error("cannot create " + o.out);
+    }
+    std::ostream& os = o.out.empty() ? std::cout : file;
+
+    os << "policy,quantum,available,admitted,avg_waiting,avg_turnaround,makespan,ms\n";
+    for (const auto& r : rows) {
+        std::string avail = "none";
+        if (!r.config.available.empty()) {
+            avail.clear();
+            for (size_t j = 0; j < r.config.available.size(); j++)
+                avail += (j ? " " : "") + std::to_string(r.config.available[j]);
+        }
+        os << Scheduler::policy_name(r.config.policy) << "," << r.config.quantum << "," << avail << ","
+           << r.admitted << "," << r.avg_waiting << "," << r.avg_turnaround << ","
+           << r.makespan << "," << r.ms << "\n";
+    }
+    return 0;
+}
+
+int run_paging_cli(BatchOptions& o) {
+    RefTrace trace(o.paging);
+    if (o.replacements.empty())
+        o.replacements = {Replacement::Fifo, Replacement::Lru, Replacement::Clock, Replacement::Arc};
+    if (o.frames.empty()) o.frames = {1024};
+
+    std::vector<PagingConfig> configs;
+    for (int frames : o.frames)
+        for (Replacement r : o.replacements)
+            configs.push_back({r, static_cast<uint32_t>(frames), static_cast<uint32_t>(o.tlb)});
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto results = run_paging(trace, configs, o.threads);
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::ofstream file;
+    if (!o.out.empty()) {
+        file.open(o.out);
+        if (!file) throw std::runtime_error("cannot create " + o.out);
+    }
+    std::ostream& os = o.out.empty() ? std::cout : file;
+
+    os << "{\"refs\":\"" << json_escape(o.paging) << "\""
+       << ",\"records\":" << trace.size()
+       << ",\"tlb_entries\":" << o.tlb
+       << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const PagingStats& r = results[i];
+        os << (i ? "," : "") << "{\"policy\":\"" << replacement_name(r.config.policy) << "\""
+           << ",\"frames\":" << r.config.frames
+           << ",\"references\":" << r.references
+           << ",\"faults\":" << r.faults
+           << ",\"fault_rate\":" << r.fault_rate()
+           << ",\"evictions\":" << r.evictions
+           << ",\"tlb_hit_rate\":" << r.tlb_hit_rate()
+           << ",\"processes\":" << r.processes
+           << ",\"exits\":" << r.exits
+           << ",\"ms\":" << r.ms
+           << ",\"mrefs_per_sec\":" << (r.ms > 0 ? double(trace.size()) / r.ms / 1e3 : 0.0) << "}";
+    }
+    os << "],\"wall_ms\":" << wall_ms << "}\n";
+    return 0;
+}
+
+} // namespace
+
+int run_batch(int argc, char** argv) {
+    BatchOptions o;
+    try {
+        o = parse_args(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        usage(std::cerr);
+        return 2;
+    }
+
+    try {
+        if (!o.convert_in.empty()) {
+            auto src = open_trace(o.convert_in);
+            size_t n = write_binary_trace(o.convert_out, *src);
+            std::cerr << "wrote " << n << " records to " << o.convert_out << "\n";
+            return 0;
+        }
+        if (!o.generate_spec.empty()) {
+            WorkloadGenerator gen(parse_workload_spec(o.generate_spec));
+            size_t n = write_binary_trace(o.generate_out, gen);
+            std::cerr << "wrote " << n << " records to " << o.generate_out << "\n";
+            return 0;
+        }
+        if (!o.events_in.empty()) {
+            auto events = EventLog::read(o.events_in);
+            std::ofstream f(o.events_out);
+            if (!f) throw std::runtime_error("cannot create " + o.events_out);
+            if (o.events_chrome) EventLog::write_chrome_json(events, f);
+            else EventLog::write_text(events, f);
+            std::cerr << "wrote " << events.size() << " events to " << o.events_out << "\n";
+            return 0;
+        }
+        if (!o.refs_spec.empty()) {
+            size_t n = write_ref_trace(o.refs_out, parse_ref_spec(o.refs_spec));
+            std::cerr << "wrote " << n << " references to " << o.refs_out << "\n";
+            return 0;
+        }
+        if (!o.paging.empty()) return run_paging_cli(o);
+        if (o.trace.empty() && o.workload.empty()) {
+            usage(std::cerr);
+            return 2;
+        }
+        if (o.sweep) return run_sweep_cli(o);
+
+        auto src = open_source(o);
+        size_t m = src->resources();
+        if (o.available.empty()) {
+            if (m != 3) throw std::invalid_argument("trace has " + std::to_string(m) +
+                                                    " resource types: pass --available");
+            o.available = {3, 3, 2};
+        }
+        if (o.available.size() != m)
+            throw std::invalid_argument("--available has " + std::to_string(o.available.size()) +
+                                        " entries, trace has " + std::to_string(m));
+
+        Simulator sim(o.buffer, /*producers*/1, /*each*/0, o.available);
+        sim.set_verbose(false);
+        sim.set_dispatchers(o.dispatchers);
+        sim.set_wakeup_order(o.wakeup);
+        if (!o.per_process.empty()) sim.set_stats_detail(StatsDetail::PerProcess);
+        if (o.use_cores) sim.set_multicore(o.multicore);
+        // Gantt outputs share one stream of merged slices
+        std::unique_ptr<ColumnarGanttWriter> gantt_file;
+        std::unique_ptr<AsciiTimeline> timeline;
+        if (!o.gantt.empty()) gantt_file = std::make_unique<ColumnarGanttWriter>(o.gantt);
+        if (o.timeline > 0) timeline = std::make_unique<AsciiTimeline>(o.timeline);
+        CallbackGanttSink gantt([&](const GanttSlice& s) {
+            if (gantt_file) gantt_file->add(s.pid, s.start, s.end);
+            if (timeline) timeline->add(s.pid, s.start, s.end);
+        });
+        bool stream = gantt_file || timeline;
+
+        std::ofstream file;
+        if (!o.out.empty()) {
+            file.open(o.out);
+            if (!file) throw std::runtime_error("cannot create " + o.out);
+        }
+        std::ostream& os = o.out.empty() ? std::cout : file;
+        auto finish_gantt = [&] {
+            if (gantt_file) gantt_file->finish();
+            if (timeline) {
+                timeline->finish();
+                std::cerr << timeline->render();
+            }
+        };
+
+        if (!o.events.empty()) EventLog::start(o.events);
+        if (o.online) {
+            OnlineReport r = sim.run_online(*src, o.policy, o.quantum, stream ? &gantt : nullptr);
+            EventLog::stop();
+            finish_gantt();
+            write_online_summary(os, o, m, r);
+            return 0;
+        }
+        RunReport r = sim.replay(*src, o.policy, o.quantum, stream ? &gantt : nullptr);
+        EventLog::stop();
+        finish_gantt();
+
+        write_summary(os, o, m, r, sim.metrics());
+        if (!o.per_process.empty()) write_per_process(o.per_process, r.schedule);
+        if (!o.checkpoint.empty()) sim.save_checkpoint(o.checkpoint);
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
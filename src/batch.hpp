@@ -0,0 +1,5 @@
+#pragma once
+
+// Headless command-line mode (anything other than the interactive menu).
+// Returns the process exit code.
+int run_batch(int argc, char** argv);
@@ -0,0 +1,359 @@
+#include "checkpoint.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "simulator.hpp"
+
+namespace {
+
+const char kCheckpointMagic[8] = {'M', 'O', 'S', 'C', 'H', 'K', 'P', 'T'};
+
+// The io section is used in place as IoRequest
+static_assert(sizeof(IoRequest) == 3 * sizeof(int32_t), "IoRequest must be three int32");
+
+constexpr uint64_t align8(uint64_t x) { return (x + 7) & ~uint64_t{7}; }
+
+// Byte offset of every section, derived from the header alone. A header
+// whose sizes overflow 64 bits (only a crafted one can) clears `valid`.
+struct Sections {
+    uint64_t available, total, pids, allocation, max_need, need, pending;
+    uint64_t records, claims, io, ready, blocked, workload, weights, max_claims, streams, end;
+    bool valid{true};
+
+    explicit Sections(const CheckpointHeader& h) {
+        uint64_t m = h.resources, n = h.banker_rows, at = sizeof(CheckpointHeader);
+        uint64_t cells = n != 0 && m > UINT64_MAX / n ? (valid = false, 0) : n * m;
+        uint64_t processes = h.records > UINT64_MAX - h.manual ? (valid = false, 0) : h.records + h.manual;
+        // count items of `size` bytes each
+        auto next = [&](uint64_t count, uint64_t size) {
+            uint64_t start = at;
+            if (count > (UINT64_MAX - 7 - at) / size) {
+                valid = false;
+                return start;
+            }
+            at = align8(at + count * size);
+            return start;
+        };
+        available = next(m, sizeof(int32_t));
+        total = next(m, sizeof(int32_t));
+        pids = next(n, sizeof(int32_t));
+        allocation = next(cells, sizeof(int32_t));
+        max_need = next(cells, sizeof(int32_t));
+        need = next(cells, sizeof(int32_t));
+        pending = next(cells, sizeof(int32_t));
+        records = next(processes, sizeof(CheckpointProcess));
+        claims = next(h.claim_values, sizeof(int32_t));
+        io = next(h.io_requests, sizeof(IoRequest));
+        ready = next(h.ready, sizeof(uint32_t));
+        blocked = next(h.blocked, sizeof(uint32_t));
+        workload = next(h.has_workload ? 1 : 0, sizeof(CheckpointWorkload));
+        weights = next(h.priority_weights, sizeof(double));
+        max_claims = next(h.max_claims, sizeof(int32_t));
+        streams = next(h.streams, sizeof(CheckpointStream));
+        end = at;
+    }
+};
+
+void write_section(std::ofstream& out, const void* data, uint64_t bytes) {
+    static const char kZeros[8] = {};
+    if (bytes) out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    out.write(kZeros, static_cast<std::streamsize>(align8(bytes) - bytes));
+}
+
+CheckpointProcess to_record(const Process& p, std::vector<int32_t>& claims, std::vector<IoRequest>& io) {
+    CheckpointProcess r{};
+    r.pid = p.pid;
+    r.arrival = p.arrival_time;
+    r.burst = p.burst_time;
+    r.remaining = p.remaining_time;
+    r.priority = p.priority;
+    r.deadline = p.deadline;
+    r.start = p.start_time;
+    r.finish = p.finish_time;
+    r.claim_len = static_cast<uint32_t>(p.max_need.size());
+    r.claim_offset = claims.size();
+    claims.insert(claims.end(), p.max_need.begin(), p.max_need.end());
+    r.io_len = static_cast<uint32_t>(p.io.size());
+    r.io_offset = io.size();
+    io.insert(io.end(), p.io.begin(), p.io.end());
+    return r;
+}
+
+void from_record(const CheckpointProcess& r, const int32_t* claims, const IoRequest* io, Process& p) {
+    p.pid = r.pid;
+    p.arrival_time = r.arrival;
+    p.burst_time = r.burst;
+    p.remaining_time = r.remaining;
+    p.priority = r.priority;
+    p.deadline = r.deadline;
+    p.start_time = r.start;
+    p.finish_time = r.finish;
+    p.max_need.assign(claims + r.claim_offset, claims + r.claim_offset + r.claim_len);
+    p.io.assign(io + r.io_offset, io + r.io_offset + r.io_len);
+}
+
+// Read-only mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open checkpoint " + path + ": " + std::strerror(errno));
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat checkpoint " + path);
+        }
+        len_ = static_cast<size_t>(st.st_size);
+        if (len_ < sizeof(CheckpointHeader)) {
+            ::close(fd);
+            throw std::runtime_error("checkpoint too small: " + path);
+        }
+        map_ = mmap(nullptr, len_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map_ == MAP_FAILED) throw std::runtime_error("mmap failed for checkpoint " + path);
+        madvise(map_, len_, MADV_SEQUENTIAL);
+    }
+    ~MappedFile() { munmap(map_, len_); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    size_t size() const { return len_; }
+    template <class T>
+    const T* at(uint64_t offset) const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(map_) + offset);
+    }
+
+private:
+    void* map_{nullptr};
+    size_t len_{0};
+};
+
+} // namespace
+
+void Simulator::save_checkpoint(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(lists_mtx_);
+
+    std::vector<CheckpointProcess> records;
+    std::vector<int32_t> claims;
+    std::vector<IoRequest> io;
+    records.reserve(pool_.size() + manual_pool_.size());
+    for (ProcessHandle h = 0; h < pool_.size(); h++) records.push_back(to_record(pool_[h], claims, io));
+    for (const Process& p : manual_pool_) records.push_back(to_record(p, claims, io));
+
+    std::vector<uint32_t> ready(ready_list_.size()), blocked(blocked_list_.size());
+    for (size_t i = 0; i < ready.size(); i++) ready[i] = ready_list_[i];
+    for (size_t i = 0; i < blocked.size(); i++) blocked[i] = blocked_list_[i];
+
+    BankerImage img = banker_.image();
+    CheckpointHeader h{};
+    std::memcpy(h.magic, kCheckpointMagic, sizeof kCheckpointMagic);
+    h.version = kCheckpointVersion;
+    h.resources = static_cast<uint32_t>(img.m);
+    h.banker_rows = img.n;
+    h.records = pool_.size();
+    h.manual = manual_pool_.size();
+    h.claim_values = claims.size();
+    h.io_requests = io.size();
+    h.ready = ready.size();
+    h.blocked = blocked.size();
+    h.detect_every = img.detect_every;
+    h.next_pid = next_pid_.load();
+    h.banker_mode = static_cast<uint32_t>(img.mode);
+    h.wakeup_order = static_cast<uint32_t>(wakeup_.order());
+    h.dispatchers = static_cast<uint32_t>(dispatchers_);
+    h.has_workload = workload_.has_value();
+    if (workload_) {
+        h.priority_weights = static_cast<uint32_t>(workload_->priority_weights.size());
+        h.max_claims = static_cast<uint32_t>(workload_->max_claim.size());
+        h.streams = static_cast<uint32_t>(streams_.size());
+    }
+    h.clock = clock_;
+    h.file_size = Sections(h).end;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("cannot create checkpoint " + path);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+
+    size_t m = img.m, cells = img.n * img.m;
+    write_section(out, img.available, m * sizeof(int32_t));
+    write_section(out, img.total, m * sizeof(int32_t));
+    write_section(out, img.pids, img.n * sizeof(int32_t));
+    write_section(out, img.allocation, cells * sizeof(int32_t));
+    write_section(out, img.max_need, cells * sizeof(int32_t));
+    write_section(out, img.need, cells * sizeof(int32_t));
+    write_section(out, img.pending, cells * sizeof(int32_t));
+    write_section(out, records.data(), records.size() * sizeof(CheckpointProcess));
+    write_section(out, claims.data(), claims.size() * sizeof(int32_t));
+    write_section(out, io.data(), io.size() * sizeof(IoRequest));
+    write_section(out, ready.data(), ready.size() * sizeof(uint32_t));
+    write_section(out, blocked.data(), blocked.size() * sizeof(uint32_t));
+    if (workload_) {
+        const WorkloadConfig& w = *workload_;
+        CheckpointWorkload cw{};
+        cw.seed = w.seed;
+        cw.count = w.count;
+        cw.first_pid = w.first_pid;
+        cw.resources = static_cast<uint32_t>(w.resources);
+        cw.arrivals = static_cast<uint32_t>(w.arrivals);
+        cw.bursts = static_cast<uint32_t>(w.bursts);
+        cw.rate = w.rate;
+        cw.group = w.group;
+        cw.factor = w.factor;
+        cw.mean_burst = w.mean_burst;
+        cw.alpha = w.alpha;
+        cw.max_burst = w.max_burst;
+        cw.correlation = w.correlation;
+        cw.deadline_slack = w.deadline_slack;
+        cw.io_requests = w.io_requests;
+        cw.devices = w.devices;
+        cw.mean_io = w.mean_io;
+        write_section(out, &cw, sizeof cw);
+        write_section(out, w.priority_weights.data(), w.priority_weights.size() * sizeof(double));
+        write_section(out, w.max_claim.data(), w.max_claim.size() * sizeof(int32_t));
+        std::vector<CheckpointStream> streams(streams_.size());
+        for (size_t i = 0; i < streams.size(); i++) {
+            std::copy(std::begin(streams_[i].s), std::end(streams_[i].s), streams[i].s);
+            streams[i].clock = streams_[i].clock;
+            streams[i].group_left = streams_[i].group_left;
+        }
+        write_section(out, streams.data(), streams.size() * sizeof(CheckpointStream));
+    }
+    out.close();
+    if (!out) throw std::runtime_error("write failed for checkpoint " + path);
+}
+
+void Simulator::restore_checkpoint(const std::string& path) {
+    MappedFile file(path);
+    CheckpointHeader h;
+    std::memcpy(&h, file.at<char>(0), sizeof h);
+    if (std::memcmp(h.magic, kCheckpointMagic, sizeof kCheckpointMagic) != 0 || h.version != kCheckpointVersion)
+        throw std::runtime_error("not a version " + std::to_string(kCheckpointVersion) + " checkpoint: " + path);
+    Sections sec(h);
+    if (!sec.valid || h.resources == 0 || h.file_size != file.size() || sec.end != file.size())
+        throw std::runtime_error("truncated or corrupt checkpoint: " + path);
+    if (h.records > ProcessPool::kCapacity || h.ready > HandleList::kCapacity ||
+        h.blocked > HandleList::kCapacity)
+        throw std::runtime_error("checkpoint exceeds the process pool: " + path);
+    if (h.banker_mode > static_cast<uint32_t>(BankerMode::Detection) ||
+        h.wakeup_order > static_cast<uint32_t>(WakeupOrder::SmallestNeed) || h.dispatchers == 0 || h.clock < 0)
+        throw std::runtime_error("corrupt checkpoint settings: " + path);
+
+    const auto* records = file.at<CheckpointProcess>(sec.records);
+    const auto* claims = file.at<int32_t>(sec.claims);
+    const auto* io = file.at<IoRequest>(sec.io);
+    for (uint64_t i = 0; i < h.records + h.manual; i++)
+        if (records[i].claim_len > h.claim_values || records[i].claim_offset > h.claim_values - records[i].claim_len ||
+            records[i].io_len > h.io_requests || records[i].io_offset > h.io_requests - records[i].io_len)
+            throw std::runtime_error("corrupt checkpoint records: " + path);
+
+    // Build the banker aside so a bad file leaves this simulator untouched
+    size_t m = h.resources;
+    const int32_t* total = file.at<int32_t>(sec.total);
+    Bankers banker(std::vector<int>(total, total + m));
+    BankerImage img;
+    img.m = m;
+    img.n = h.banker_rows;
+    img.available = file.at<int32_t>(sec.available);
+    img.total = total;
+    img.pids = file.at<int32_t>(sec.pids);
+    img.allocation = file.at<int32_t>(sec.allocation);
+    img.max_need = file.at<int32_t>(sec.max_need);
+    img.need = file.at<int32_t>(sec.need);
+    img.pending = file.at<int32_t>(sec.pending);
+    img.mode = static_cast<BankerMode>(h.banker_mode);
+    img.detect_every = h.detect_every;
+    try {
+        banker.load_image(img);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("corrupt checkpoint banker (" + std::string(e.what()) + "): " + path);
+    }
+
+    const uint32_t* ready = file.at<uint32_t>(sec.ready);
+    const uint32_t* blocked = file.at<uint32_t>(sec.blocked);
+    for (uint64_t i = 0; i < h.ready; i++)
+        if (ready[i] >= h.records) throw std::runtime_error("corrupt checkpoint lists: " + path);
+    for (uint64_t i = 0; i < h.blocked; i++)
+        if (blocked[i] >= h.records) throw std::runtime_error("corrupt checkpoint lists: " + path);
+
+    std::optional<WorkloadConfig> workload;
+    std::vector<GeneratorState> streams(h.streams);
+    if (!h.has_workload && h.streams != 0) throw std::runtime_error("corrupt checkpoint streams: " + path);
+    if (h.has_workload) {
+        const auto* cw = file.at<CheckpointWorkload>(sec.workload);
+        if (cw->arrivals > static_cast<uint32_t>(ArrivalModel::Bursty) ||
+            cw->bursts > static_cast<uint32_t>(BurstModel::Pareto))
+            throw std::runtime_error("corrupt checkpoint workload: " + path);
+        WorkloadConfig w;
+        w.seed = cw->seed;
+        w.count = cw->count;
+        w.first_pid = cw->first_pid;
+        w.resources = cw->resources;
+        w.arrivals = static_cast<ArrivalModel>(cw->arrivals);
+        w.bursts = static_cast<BurstModel>(cw->bursts);
+        w.rate = cw->rate;
+        w.group = cw->group;
+        w.factor = cw->factor;
+        w.mean_burst = cw->mean_burst;
+        w.alpha = cw->alpha;
+        w.max_burst = cw->max_burst;
+        w.correlation = cw->correlation;
+        w.deadline_slack = cw->deadline_slack;
+        w.io_requests = cw->io_requests;
+        w.devices = cw->devices;
+        w.mean_io = cw->mean_io;
+        const double* weights = file.at<double>(sec.weights);
+        const int32_t* max_claim = file.at<int32_t>(sec.max_claims);
+        w.priority_weights.assign(weights, weights + h.priority_weights);
+        w.max_claim.assign(max_claim, max_claim + h.max_claims);
+        try {
+            WorkloadGenerator check(w);   // throws on a config the generator rejects
+        } catch (const std::invalid_argument& e) {
+            throw std::runtime_error("corrupt checkpoint workload (" + std::string(e.what()) + "): " + path);
+        }
+        workload = w;
+        const auto* cs = file.at<CheckpointStream>(sec.streams);
+        for (uint32_t i = 0; i < h.streams; i++) {
+            if (!(cs[i].clock >= 0)) throw std::runtime_error("corrupt checkpoint streams: " + path);
+            std::copy(std::begin(cs[i].s), std::end(cs[i].s), streams[i].s);
+            streams[i].clock = cs[i].clock;
+            streams[i].group_left = cs[i].group_left;
+        }
+    }
+
+    std::vector<Process> manual(h.manual);
+    for (uint64_t i = 0; i < h.manual; i++) from_record(records[h.records + i], claims, io, manual[i]);
+
+    // Everything is validated: nothing below rejects the file
+    std::lock_guard<std::mutex> lock(lists_mtx_);
+    banker_ = std::move(banker);
+    wakeup_ = WakeupIndex(m);
+    wakeup_.set_order(static_cast<WakeupOrder>(h.wakeup_order));
+    indexed_ = 0;
+
+    pool_.clear();
+    Process p;
+    for (uint64_t i = 0; i < h.records; i++) {
+        from_record(records[i], claims, io, p);
+        pool_.create(p);
+    }
+    manual_pool_ = std::move(manual);
+
+    ready_list_.clear();
+    blocked_list_.clear();
+    for (uint64_t i = 0; i < h.ready; i++) ready_list_.push_back(ready[i]);
+    for (uint64_t i = 0; i < h.blocked; i++) blocked_list_.push_back(blocked[i]);
+
+    next_pid_.store(h.next_pid);
+    dispatchers_ = static_cast<int>(h.dispatchers);
+    workload_ = std::move(workload);
+    streams_ = std::move(streams);
+    clock_ = h.clock;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+// Simulator checkpoint file (Simulator::save_checkpoint / restore_checkpoint).
+//
+// Layout: CheckpointHeader, then these sections, each padded to 8 bytes and
+// present with the lengths the header gives (host byte order):
+//   int32  available[m], total[m]
+//   int32  pids[n], allocation[n*m], max_need[n*m], need[n*m], pending[n*m]
+//   CheckpointProcess  records[records + manual]   pool records, then the manual pool
+//   int32  claims[claim_values]                     claim vectors of the records
+//   int32  io[io_requests * 3]                      (at, duration, device) of the records
+//   uint32 ready[ready], blocked[blocked]           pool handles
+//   CheckpointWorkload, double weights[..], int32 max_claim[..]   if has_workload
+//   CheckpointStream  streams[streams]             generator state per producer
+// Every section is used in place from the mapping: restore copies arrays,
+// it never parses text or walks a variable-length encoding.
+
+constexpr uint32_t kCheckpointVersion = 4;
+
+struct CheckpointHeader {
+    char magic[8];              // "MOSCHKPT"
+    uint32_t version;           // kCheckpointVersion
+    uint32_t resources;         // m
+    uint64_t banker_rows;       // n
+    uint64_t records;           // pool records (handle i = record i)
+    uint64_t manual;            // manual pool records
+    uint64_t claim_values;
+    uint64_t io_requests;
+    uint64_t ready;
+    uint64_t blocked;
+    uint64_t detect_every;
+    int32_t next_pid;
+    uint32_t banker_mode;       // BankerMode
+    uint32_t wakeup_order;      // WakeupOrder
+    uint32_t dispatchers;
+    uint32_t has_workload;
+    uint32_t priority_weights;  // workload array lengths
+    uint32_t max_claims;
+    uint32_t streams;           // generator states (0 without a workload)
+    int32_t clock;              // simulated time reached
+    uint32_t reserved;
+    uint64_t file_size;         // whole file, to detect truncation
+};
+
+struct CheckpointProcess {
+    int32_t pid, arrival, burst, remaining, priority, deadline, start, finish;
+    uint32_t claim_len;
+    uint32_t io_len;
+    uint64_t claim_offset;      // index into claims[]
+    uint64_t io_offset;         // index into io[], in requests
+};
+
+// Fixed part of a WorkloadConfig
+struct CheckpointWorkload {
+    uint64_t seed;
+    uint64_t count;
+    int32_t first_pid;
+    uint32_t resources;
+    uint32_t arrivals;          // ArrivalModel
+    uint32_t bursts;            // BurstModel
+    double rate, group, factor, mean_burst, alpha;
+    int32_t max_burst;
+    int32_t reserved;
+    double correlation, deadline_slack;
+    int32_t io_requests, devices;
+    double mean_io;
+};
+
+// GeneratorState of one producer's stream
+struct CheckpointStream {
+    uint64_t s[4];
+    double clock;
+    uint64_t group_left;
+};
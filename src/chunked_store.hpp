@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+// Array of T split into fixed-size chunks that are allocated on first use
+// and never move, so references stay valid while other threads grow it.
+// Chunks are value-initialised and kept until destruction.
+template <class T, size_t ChunkBits = 12, size_t MaxChunks = 4096>
+class ChunkedStore {
+public:
+    static constexpr size_t kChunkSize = size_t{1} << ChunkBits;
+    static constexpr size_t kCapacity = kChunkSize * MaxChunks;
+
+    ChunkedStore() : chunks_(new std::atomic<T*>[MaxChunks]) {
+        for (size_t c = 0; c < MaxChunks; c++) chunks_[c].store(nullptr, std::memory_order_relaxed);
+    }
+    ~ChunkedStore() {
+        for (size_t c = 0; c < MaxChunks; c++) delete[] chunks_[c].load(std::memory_order_relaxed);
+    }
+
+    ChunkedStore(const ChunkedStore&) = delete;
+    ChunkedStore& operator=(const ChunkedStore&) = delete;
+
+    // Element i, whose chunk must already exist
+    T& operator[](size_t i) { return chunk(i >> ChunkBits)[i & (kChunkSize - 1)]; }
+    const T& operator[](size_t i) const { return chunk(i >> ChunkBits)[i & (kChunkSize - 1)]; }
+
+    // Element i, allocating its chunk if needed (thread-safe; i < kCapacity)
+    T& at_grow(size_t i) {
+        size_t c = i >> ChunkBits;
+        T* p = chunks_[c].load(std::memory_order_acquire);
+        if (!p) {
+            std::lock_guard<std::mutex> lock(grow_mtx_);
+            p = chunks_[c].load(std::memory_order_relaxed);
+            if (!p) {
+                p = new T[kChunkSize]();
+                chunks_[c].store(p, std::memory_order_release);
+            }
+        }
+        return p[i & (kChunkSize - 1)];
+    }
+
+private:
+    std::unique_ptr<std::atomic<T*>[]> chunks_;
+    std::mutex grow_mtx_;
+
+    T* chunk(size_t c) const { return chunks_[c].load(std::memory_order_acquire); }
+};
@@ -0,0 +1,300 @@
+#include "event_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+static const char kEventMagic[8] = {'M', 'O', 'S', 'E', 'V', 'E', 'N', 'T'};
+
+std::atomic<bool> EventLog::enabled_{false};
+
+namespace {
+
+constexpr size_t kRingSize = 1 << 14; // records per thread
+
+// Single producer (the owning thread), single consumer (the writer).
+// `active` is set while the owner is inside append(), so stop() can wait
+// for appends in flight before the final drain.
+struct Ring {
+    uint32_t id{0};
+    std::atomic<bool> active{false};
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    EventRecord slots[kRingSize];
+};
+
+// A ring outlives its thread: on exit it goes to `free` for the next thread
+// (undrained records keep their old thread id), so the number of rings
+// follows the peak number of live emitting threads.
+struct Writer {
+    std::mutex mtx;                          // rings, free list and file
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> free;
+    uint32_t next_id{0};
+    std::FILE* file{nullptr};
+
+    std::mutex wake_mtx;
+    std::condition_variable wake;            // writer: stop or a full ring
+    std::condition_variable space;           // producers: a drain finished
+    bool stopping{false};
+    int full_waiters{0};
+    std::thread thread;
+
+    std::atomic<int64_t> origin_ns{0};
+};
+
+Writer& writer() {
+    static Writer* w = new Writer; // leaked: threads may emit during static destruction
+    return *w;
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Ring* acquire_ring() {
+    Writer& w = writer();
+    std::lock_guard<std::mutex> lock(w.mtx);
+    if (w.free.empty()) {
+        w.rings.push_back(std::make_unique<Ring>());
+        w.free.push_back(w.rings.back().get());
+    }
+    Ring* ring = w.free.back();
+    w.free.pop_back();
+    ring->id = w.next_id++;
+    return ring;
+}
+
+void release_ring(Ring* ring) {
+    Writer& w = writer();
+    std::lock_guard<std::mutex> lock(w.mtx);
+    w.free.push_back(ring);
+}
+
+thread_local Ring* tls_ring = nullptr;
+thread_local bool tls_exited = false;
+
+// Returns the ring to the free list when its thread exits
+struct RingLease {
+    Ring* ring{nullptr};
+    ~RingLease() {
+        if (!ring) return;
+        release_ring(ring);
+        tls_ring = nullptr;
+        tls_exited = true;
+    }
+};
+
+Ring& local_ring() {
+    if (!tls_ring) {
+        thread_local RingLease lease;
+        lease.ring = tls_ring = acquire_ring();
+    }
+    return *tls_ring;
+}
+
+// Blocks until the writer has made room in r
+void wait_for_space(Writer& w, Ring& r, size_t tail) {
+    std::unique_lock<std::mutex> lock(w.wake_mtx);
+    w.full_waiters++;
+    w.wake.notify_one();
+    w.space.wait(lock, [&] { return tail - r.head.load(std::memory_order_acquire) < kRingSize; });
+    w.full_waiters--;
+}
+
+// Caller holds w.mtx
+void drain(Writer& w) {
+    for (auto& ring : w.rings) {
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        size_t tail = ring->tail.load(std::memory_order_acquire);
+        while (head != tail) {
+            // Contiguous run up to the wrap point
+            size_t from = head % kRingSize;
+            size_t n = std::min(tail - head, kRingSize - from);
+            if (w.file) std::fwrite(&ring->slots[from], sizeof(EventRecord), n, w.file);
+            head += n;
+        }
+        ring->head.store(head, std::memory_order_release);
+    }
+}
+
+void writer_loop() {
+    Writer& w = writer();
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(w.wake_mtx);
+            w.wake.wait_for(lock, std::chrono::milliseconds(1), [&] { return w.stopping || w.full_waiters > 0; });
+            stopping = w.stopping;
+        }
+        {
+            std::lock_guard<std::mutex> lock(w.mtx);
+            drain(w);
+        }
+        {
+            std::lock_guard<std::mutex> lock(w.wake_mtx); // orders the drain before a waiter's check
+        }
+        w.space.notify_all();
+        if (stopping) break;
+    }
+}
+
+} // namespace
+
+void EventLog::start(const std::string& path) {
+    if (enabled()) throw std::runtime_error("event log already started");
+    Writer& w = writer();
+    {
+        std::lock_guard<std::mutex> lock(w.mtx);
+        w.file = std::fopen(path.c_str(), "wb");
+        if (!w.file) throw std::runtime_error("cannot create event log " + path);
+
+        EventLogHeader h{};
+        std::memcpy(h.magic, kEventMagic, sizeof kEventMagic);
+        h.version = kEventLogVersion;
+        h.record_size = sizeof(EventRecord);
+        std::fwrite(&h, sizeof h, 1, w.file);
+
+        // Forget events emitted while no log was open
+        for (auto& ring : w.rings) ring->head.store(ring->tail.load(std::memory_order_acquire));
+    }
+    w.stopping = false;
+    w.origin_ns.store(now_ns(), std::memory_order_relaxed);
+    w.thread = std::thread(writer_loop);
+    enabled_.store(true, std::memory_order_release);
+}
+
+void EventLog::stop() {
+    if (!enabled()) return;
+    enabled_.store(false);
+    Writer& w = writer();
+
+    // Appends that saw the log enabled finish before the final drain; any
+    // later one sees it disabled (see append)
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(w.mtx);
+        for (auto& ring : w.rings) rings.push_back(ring.get());
+    }
+    for (Ring* ring : rings)
+        while (ring->active.load()) std::this_thread::yield(); // a full ring waits on the writer
+    {
+        std::lock_guard<std::mutex> lock(w.wake_mtx);
+        w.stopping = true;
+    }
+    w.wake.notify_one();
+    w.thread.join();
+
+    std::lock_guard<std::mutex> lock(w.mtx);
+    std::fclose(w.file);
+    w.file = nullptr;
+}
+
+void EventLog::append(EventType type, int pid, int a, int b, int cpu) {
+    // Emitted from a thread_local destructor after the lease was returned:
+    // borrow a ring for this one record
+    Ring* borrowed = tls_exited ? acquire_ring() : nullptr;
+    Ring& r = borrowed ? *borrowed : local_ring();
+    Writer& w = writer();
+
+    // Pairs with stop(): either stop() waits for this append, or this
+    // append sees the log disabled
+    r.active.store(true);
+    if (!enabled_.load()) {
+        r.active.store(false, std::memory_order_release);
+        if (borrowed) release_ring(borrowed);
+        return;
+    }
+
+    // Ring full: sleep until the writer catches up instead of dropping the record
+    size_t tail = r.tail.load(std::memory_order_relaxed);
+    if (tail - r.head.load(std::memory_order_acquire) == kRingSize) wait_for_space(w, r, tail);
+
+    EventRecord& e = r.slots[tail % kRingSize];
+    e.ts_ns = static_cast<uint64_t>(now_ns() - w.origin_ns.load(std::memory_order_relaxed));
+    e.thread = r.id;
+    e.type = static_cast<uint16_t>(type);
+    e.reserved = 0;
+    e.pid = pid;
+    e.a = a;
+    e.b = b;
+    e.cpu = cpu;
+    r.tail.store(tail + 1, std::memory_order_release);
+    r.active.store(false, std::memory_order_release);
+    if (borrowed) release_ring(borrowed);
+}
+
+const char* EventLog::type_name(EventType type) {
+    switch (type) {
+    case EventType::Push:    return "push";
+    case EventType::Pop:     return "pop";
+    case EventType::Admit:   return "admit";
+    case EventType::Block:   return "block";
+    case EventType::Unblock: return "unblock";
+    case EventType::Slice:   return "slice";
+    }
+    return "?";
+}
+
+// ---------------- offline conversion ----------------
+
+std::vector<EventRecord> EventLog::read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open event log " + path);
+
+    EventLogHeader h{};
+    in.read(reinterpret_cast<char*>(&h), sizeof h);
+    if (!in || std::memcmp(h.magic, kEventMagic, sizeof kEventMagic) != 0 ||
+        h.version != kEventLogVersion || h.record_size != sizeof(EventRecord))
+        throw std::runtime_error("not a version " + std::to_string(kEventLogVersion) + " event log: " + path);
+
+    std::vector<EventRecord> events;
+    EventRecord e;
+    while (in.read(reinterpret_cast<char*>(&e), sizeof e)) events.push_back(e);
+    if (in.gcount() != 0) throw std::runtime_error("truncated event log: " + path);
+
+    // Threads were drained in turn; restore one global timeline
+    std::stable_sort(events.begin(), events.end(), [](const EventRecord& x, const EventRecord& y) {
+        return x.ts_ns < y.ts_ns;
+    });
+    return events;
+}
+
+void EventLog::write_text(const std::vector<EventRecord>& events, std::ostream& os) {
+    for (const auto& e : events) {
+        os << e.ts_ns << " T" << e.thread << " " << type_name(static_cast<EventType>(e.type))
+           << " P" << e.pid;
+        if (static_cast<EventType>(e.type) == EventType::Slice)
+            os << " " << e.a << "-" << e.b << " cpu" << e.cpu;
+        os << "\n";
+    }
+}
+
+// Chrome trace event format (chrome://tracing, Perfetto). Thread activity
+// is an instant event on wall time (process 1); CPU slices are complete
+// events on simulated time, one unit shown as 1 us (process 2).
+void EventLog::write_chrome_json(const std::vector<EventRecord>& events, std::ostream& os) {
+    os << "{\"traceEvents\":[\n"
+       << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"simulator threads\"}},\n"
+       << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"CPU (simulated time)\"}}";
+    for (const auto& e : events) {
+        auto type = static_cast<EventType>(e.type);
+        os << ",\n";
+        if (type == EventType::Slice) {
+            os << "{\"name\":\"P" << e.pid << "\",\"ph\":\"X\",\"pid\":2,\"tid\":" << e.cpu
+               << ",\"ts\":" << e.a << ",\"dur\":" << (e.b - e.a) << "}";
+        } else {
+            os << "{\"name\":\"" << type_name(type) << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1"
+               << ",\"tid\":" << e.thread << ",\"ts\":" << e.ts_ns / 1000.0
+               << ",\"args\":{\"pid\":" << e.pid << "}}";
+        }
+    }
+    os << "\n]}\n";
+}
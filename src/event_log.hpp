@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Binary event log of the simulation threads.
+//
+// emit() appends a fixed-size record to the calling thread's SPSC ring
+// (no locks, no syscalls); a background writer drains all rings to the
+// file. A full ring makes the emitting thread sleep until the writer has
+// drained it rather than drop the event. Rings of exited threads are
+// reused. File layout: EventLogHeader, then EventRecords in per-thread
+// order (records of one thread are in timestamp order).
+
+enum class EventType : uint16_t {
+    Push = 1,     // producer put pid into the ready buffer
+    Pop,          // dispatcher took pid out of the ready buffer
+    Admit,        // Banker's check passed
+    Block,        // Banker's check failed
+    Unblock,      // blocked pid admitted after a release
+    Slice,        // pid ran on core `cpu` from a to b (simulated time)
+};
+
+struct EventRecord {
+    uint64_t ts_ns;    // wall time since EventLog::start
+    uint32_t thread;   // small id in registration order
+    uint16_t type;     // EventType
+    uint16_t reserved;
+    int32_t pid;
+    int32_t a;
+    int32_t b;
+    int32_t cpu;       // Slice: core that ran it
+};
+static_assert(sizeof(EventRecord) == 32, "event records are fixed size");
+
+constexpr uint32_t kEventLogVersion = 1;
+
+struct EventLogHeader {
+    char magic[8];     // "MOSEVENT"
+    uint32_t version;  // kEventLogVersion
+    uint32_t record_size;
+};
+
+class EventLog {
+public:
+    // Starts the writer thread; throws runtime_error if path cannot be created
+    static void start(const std::string& path);
+    // Waits for appends in flight, drains every ring, stops the writer and
+    // closes the file. Events emitted after stop() begins are not logged.
+    static void stop();
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Cheap no-op unless started
+    static void emit(EventType type, int pid, int a = 0, int b = 0, int cpu = 0) {
+        if (enabled()) append(type, pid, a, b, cpu);
+    }
+
+    static const char* type_name(EventType type);
+
+    // Offline conversion
+    static std::vector<EventRecord> read(const std::string& path);
+    static void write_text(const std::vector<EventRecord>& events, std::ostream& os);
+    static void write_chrome_json(const std::vector<EventRecord>& events, std::ostream& os);
+
+private:
+    static std::atomic<bool> enabled_;
+    static void append(EventType type, int pid, int a, int b, int cpu);
+};
@@ -0,0 +1,154 @@
+#include "gantt.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char kGanttMagic[8] = {'M', 'O', 'S', 'G', 'A', 'N', 'T', 'T'};
+
+// ---------------- GanttSink ----------------
+
+void GanttSink::add(int pid, int start, int end) {
+    if (end <= start) return;
+    if (has_pending_ && pending_.pid == pid && pending_.end == start) {
+        pending_.end = end;
+        return;
+    }
+    if (has_pending_) on_slice(pending_);
+    pending_ = {pid, start, end};
+    has_pending_ = true;
+}
+
+void GanttSink::finish() {
+    if (has_pending_) on_slice(pending_);
+    has_pending_ = false;
+    on_finish();
+}
+
+// ---------------- ColumnarGanttWriter ----------------
+
+ColumnarGanttWriter::ColumnarGanttWriter(const std::string& path) : path_(path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) throw std::runtime_error("cannot create " + path);
+
+    std::memcpy(header_.magic, kGanttMagic, sizeof kGanttMagic);
+    header_.version = kGanttFileVersion;
+    header_.block_rows = kGanttBlockRows;
+    header_.count = 0;
+    std::fwrite(&header_, sizeof header_, 1, file_); // count patched by on_finish
+
+    pid_.reserve(kGanttBlockRows);
+    start_.reserve(kGanttBlockRows);
+    len_.reserve(kGanttBlockRows);
+}
+
+ColumnarGanttWriter::~ColumnarGanttWriter() {
+    if (file_) std::fclose(file_);
+}
+
+void ColumnarGanttWriter::on_slice(const GanttSlice& s) {
+    pid_.push_back(s.pid);
+    start_.push_back(s.start);
+    len_.push_back(s.end - s.start);
+    header_.count++;
+    if (pid_.size() == kGanttBlockRows) flush_block();
+}
+
+void ColumnarGanttWriter::flush_block() {
+    if (pid_.empty()) return;
+    std::fwrite(pid_.data(), sizeof(int32_t), pid_.size(), file_);
+    std::fwrite(start_.data(), sizeof(int32_t), start_.size(), file_);
+    std::fwrite(len_.data(), sizeof(int32_t), len_.size(), file_);
+    pid_.clear();
+    start_.clear();
+    len_.clear();
+}
+
+void ColumnarGanttWriter::on_finish() {
+    flush_block();
+    std::fseek(file_, 0, SEEK_SET);
+    std::fwrite(&header_, sizeof header_, 1, file_);
+    bool ok = std::ferror(file_) == 0;
+    std::fclose(file_);
+    file_ = nullptr;
+    if (!ok) throw std::runtime_error("write failed for " + path_);
+}
+
+std::vector<GanttSlice> read_gantt_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open " + path);
+
+    GanttFileHeader h{};
+    in.read(reinterpret_cast<char*>(&h), sizeof h);
+    if (!in || std::memcmp(h.magic, kGanttMagic, sizeof kGanttMagic) != 0 ||
+        h.version != kGanttFileVersion || h.block_rows == 0)
+        throw std::runtime_error("not a version " + std::to_string(kGanttFileVersion) + " gantt file: " + path);
+
+    std::vector<GanttSlice> slices;
+    slices.reserve(h.count);
+    std::vector<int32_t> pid, start, len;
+    for (uint64_t done = 0; done < h.count;) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(h.block_rows, h.count - done));
+        pid.resize(n);
+        start.resize(n);
+        len.resize(n);
+        in.read(reinterpret_cast<char*>(pid.data()), n * sizeof(int32_t));
+        in.read(reinterpret_cast<char*>(start.data()), n * sizeof(int32_t));
+        in.read(reinterpret_cast<char*>(len.data()), n * sizeof(int32_t));
+        if (!in) throw std::runtime_error("truncated gantt file: " + path);
+        for (size_t i = 0; i < n; i++) slices.push_back({pid[i], start[i], start[i] + len[i]});
+        done += n;
+    }
+    return slices;
+}
+
+// ---------------- AsciiTimeline ----------------
+
+AsciiTimeline::AsciiTimeline(int width) : width_(width) {
+    if (width <= 0) throw std::invalid_argument("timeline width must be > 0");
+    cells_.assign(2 * static_cast<size_t>(width), -1);
+}
+
+void AsciiTimeline::on_slice(const GanttSlice& s) {
+    const long long samples = static_cast<long long>(cells_.size());
+    horizon_ = std::max<long long>(horizon_, s.end);
+
+    // Double the scale until the slice fits; sample c stays the one at c * scale
+    while (s.end > samples * scale_) {
+        size_t kept = (cells_.size() + 1) / 2;
+        for (size_t c = 0; c < kept; c++) cells_[c] = cells_[2 * c];
+        std::fill(cells_.begin() + kept, cells_.end(), -1);
+        scale_ *= 2;
+    }
+
+    // Samples whose time lies in [start, end)
+    long long first = (s.start + scale_ - 1) / scale_;
+    long long last = (static_cast<long long>(s.end) + scale_ - 1) / scale_;
+    for (long long c = first; c < last; c++) cells_[c] = s.pid;
+}
+
+std::string AsciiTimeline::render() const {
+    static const char kSymbols[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    constexpr int kNumSymbols = sizeof kSymbols - 1;
+
+    size_t used = static_cast<size_t>(std::min<long long>(static_cast<long long>(cells_.size()),
+                                                          (horizon_ + scale_ - 1) / scale_));
+    size_t columns = std::min(used, static_cast<size_t>(width_));
+    std::string line = "|";
+    for (size_t c = 0; c < columns; c++) {
+        int pid = cells_[c * used / columns];
+        // Unsigned modulo: a negative pid other than idle still maps to a symbol
+        line += pid == -1 ? '.' : kSymbols[static_cast<unsigned>(pid) % kNumSymbols];
+    }
+    line += "|\n";
+
+    std::string end = std::to_string(horizon_);
+    std::string axis = "0";
+    // Right-align the end time under the closing '|'
+    size_t pad = columns + 2 > 1 + end.size() ? columns + 1 - end.size() : 1;
+    axis += std::string(pad, ' ');
+    axis += end;
+    double per_column = columns ? static_cast<double>(used) * scale_ / columns : 0.0;
+    return line + axis + "  (1 column ~ " + std::to_string(static_cast<long long>(per_column + 0.5)) +
+           " time units)\n";
+}
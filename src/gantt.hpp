@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "scheduler.hpp"
+
+// Streaming Gantt output. Schedulers hand every slice to a sink as soon as
+// it is decided; add() run-length merges a slice that continues the previous
+// one (same pid, no gap), so sinks only see maximal runs.
+class GanttSink {
+public:
+    virtual ~GanttSink() = default;
+
+    void add(int pid, int start, int end);
+    // Emits the pending run; call once after the last add()
+    void finish();
+
+protected:
+    virtual void on_slice(const GanttSlice& s) = 0;
+    virtual void on_finish() {}
+
+private:
+    GanttSlice pending_{};
+    bool has_pending_{false};
+};
+
+class VectorGanttSink : public GanttSink {
+public:
+    std::vector<GanttSlice> slices;
+
+protected:
+    void on_slice(const GanttSlice& s) override { slices.push_back(s); }
+};
+
+class CallbackGanttSink : public GanttSink {
+public:
+    explicit CallbackGanttSink(std::function<void(const GanttSlice&)> fn) : fn_(std::move(fn)) {}
+
+protected:
+    void on_slice(const GanttSlice& s) override { fn_(s); }
+
+private:
+    std::function<void(const GanttSlice&)> fn_;
+};
+
+// Columnar binary export: GanttFileHeader, then blocks of kGanttBlockRows
+// rows (the last one may be shorter), each stored as three int32 columns
+// pid[n], start[n], length[n]. Fixed block size keeps row i addressable.
+constexpr uint32_t kGanttFileVersion = 1;
+constexpr uint32_t kGanttBlockRows = 4096;
+
+struct GanttFileHeader {
+    char magic[8];        // "MOSGANTT"
+    uint32_t version;     // kGanttFileVersion
+    uint32_t block_rows;  // kGanttBlockRows
+    uint64_t count;       // rows
+};
+
+class ColumnarGanttWriter : public GanttSink {
+public:
+    explicit ColumnarGanttWriter(const std::string& path); // throws runtime_error
+    ~ColumnarGanttWriter() override;
+
+    ColumnarGanttWriter(const ColumnarGanttWriter&) = delete;
+    ColumnarGanttWriter& operator=(const ColumnarGanttWriter&) = delete;
+
+    uint64_t rows() const { return header_.count; }
+
+protected:
+    void on_slice(const GanttSlice& s) override;
+    void on_finish() override;
+
+private:
+    std::FILE* file_{nullptr};
+    std::string path_;
+    GanttFileHeader header_{};
+    std::vector<int32_t> pid_, start_, len_;
+
+    void flush_block();
+};
+
+// Reads a columnar Gantt file back (whole file in memory)
+std::vector<GanttSlice> read_gantt_file(const std::string& path);
+
+// Fixed-width ASCII timeline built while streaming. Sample c holds the pid
+// running at time c * scale, for 2 * width samples; when a slice ends past
+// the last sample the scale doubles and every other sample is kept. A slice
+// costs O(1) plus the samples it covers, so O(width) at worst; each doubling
+// costs O(width) and happens once per doubling of the horizon. Memory is
+// O(width), and render() resamples the used samples to at most `width`
+// columns in O(width).
+class AsciiTimeline : public GanttSink {
+public:
+    explicit AsciiTimeline(int width);
+
+    // Two lines: the timeline ('.' = idle) and the time axis
+    std::string render() const;
+
+protected:
+    void on_slice(const GanttSlice& s) override;
+
+private:
+    int width_;
+    std::vector<int> cells_;   // pid per sample, -1 = idle
+    long long scale_{1};       // time units per sample
+    long long horizon_{0};     // largest end seen
+};
@@ -1,5 +1,10 @@
+#include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
+#include <string>
+#include "batch.hpp"
+#include "event_log.hpp"
 #include "simulator.hpp"
 #include "process.hpp"
 
@@ -22,16 +27,25 @@ static std::vector<int> read_vector(int m) {
     return v;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Any argument selects the headless batch mode
+    if (argc > 1) return run_batch(argc, argv);
+
     // Defaults (you can change)
     // available = {3,3,2} means 3 resource types
     Simulator sim(/*buffer*/5, /*producers*/2, /*each*/5, /*available*/{3,3,2});
 
+    // MOS_EVENT_LOG=FILE records a binary event log of the whole session
+    if (const char* log = std::getenv("MOS_EVENT_LOG")) EventLog::start(log);
+
     while (true) {
         std::cout << "\n===== MINI OS SIM MENU =====\n";
         std::cout << "1) Start Simulation\n";
         std::cout << "2) Add Process\n";
         std::cout << "3) Display State\n";
+        std::cout << "5) Display Metrics\n";
+        std::cout << "6) Save Checkpoint\n";
+        std::cout << "7) Restore Checkpoint\n";
         std::cout << "4) Exit\n";
 
         int choice = read_int("Enter choice: ");
@@ -52,7 +66,21 @@ int main() {
             sim.display_state();
         } else if (choice == 4) {
             std::cout << "Exiting...\n";
+            EventLog::stop();
             break;
+        } else if (choice == 5) {
+            sim.display_metrics();
+        } else if (choice == 6 || choice == 7) {
+            std::string path;
+            std::cout << "Checkpoint file: ";
+            std::cin >> path;
+            try {
+                if (choice == 6) sim.save_checkpoint(path);
+                else sim.restore_checkpoint(path);
+                std::cout << (choice == 6 ? "Saved " : "Restored ") << path << "\n";
+            } catch (const std::exception& e) {
+                std::cout << "Checkpoint failed: " << e.what() << "\n";
+            }
         } else {
             std::cout << "Invalid choice.\n";
         }
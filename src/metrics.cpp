@@ -0,0 +1,205 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+// ---------------- LatencyHistogram ----------------
+
+size_t LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < (1u << kSubBits)) return static_cast<size_t>(ns);
+    int e = 63 - __builtin_clzll(ns);                      // e >= kSubBits
+    uint64_t sub = (ns >> (e - kSubBits)) & ((1u << kSubBits) - 1);
+    return (static_cast<size_t>(e - kSubBits + 1) << kSubBits) + sub;
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t b) {
+    if (b < (1u << kSubBits)) return b;
+    int e = static_cast<int>(b >> kSubBits) + kSubBits - 1;
+    uint64_t sub = b & ((1u << kSubBits) - 1);
+    uint64_t lower = ((1ull << kSubBits) + sub) << (e - kSubBits);
+    return lower + ((1ull << (e - kSubBits)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets[bucket_of(ns)]++;
+    count_++;
+    sum_ += ns;
+    max_ = std::max(max_, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t b = 0; b < kBuckets; b++) buckets[b] += other.buckets[b];
+    merge_totals(other.count_, other.sum_, other.max_);
+}
+
+void LatencyHistogram::merge_totals(uint64_t count, uint64_t sum, uint64_t max) {
+    count_ += count;
+    sum_ += sum;
+    max_ = std::max(max_, max);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) return 0;
+    // Rank of the sample we want (1-based), then the bucket holding it
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count_));
+    rank = std::min(std::max<uint64_t>(rank, 1), count_);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; b++) {
+        seen += buckets[b];
+        if (seen >= rank) return std::min(bucket_upper(b), max_);
+    }
+    return max_;
+}
+
+// ---------------- per-thread blocks ----------------
+
+namespace {
+
+constexpr size_t kProbes = static_cast<size_t>(Probe::Count);
+
+// Written only by its owning thread; read by snapshot() at any time
+struct ThreadBlock {
+    struct Hist {
+        std::atomic<uint64_t> buckets[LatencyHistogram::kBuckets];
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        Hist() { for (auto& b : buckets) b.store(0, std::memory_order_relaxed); }
+    };
+    Hist hist[kProbes];
+};
+
+// Live blocks belong to running threads. When a thread exits its block is
+// folded into `retired` and parked on the free list for the next thread, so
+// memory tracks the peak number of concurrent threads, not the total.
+struct Registry {
+    std::mutex mtx;
+    std::vector<ThreadBlock*> live;
+    std::vector<std::unique_ptr<ThreadBlock>> owned;
+    std::vector<ThreadBlock*> free;
+    std::vector<LatencyHistogram> retired = std::vector<LatencyHistogram>(kProbes);
+};
+
+Registry& registry() {
+    static Registry* r = new Registry; // leaked: threads may record during static destruction
+    return *r;
+}
+
+void fold(ThreadBlock::Hist& h, LatencyHistogram& dst) {
+    for (size_t b = 0; b < LatencyHistogram::kBuckets; b++)
+        dst.buckets[b] += h.buckets[b].load(std::memory_order_relaxed);
+    dst.merge_totals(h.count.load(std::memory_order_relaxed), h.sum.load(std::memory_order_relaxed),
+                     h.max.load(std::memory_order_relaxed));
+}
+
+void clear(ThreadBlock& block) {
+    for (auto& h : block.hist) {
+        for (auto& b : h.buckets) b.store(0, std::memory_order_relaxed);
+        h.count.store(0, std::memory_order_relaxed);
+        h.sum.store(0, std::memory_order_relaxed);
+        h.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+thread_local ThreadBlock* tls_block = nullptr;
+thread_local bool tls_exited = false;
+
+// Returns the block to the registry when its thread exits
+struct BlockLease {
+    ThreadBlock* block{nullptr};
+    ~BlockLease() {
+        if (!block) return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        for (size_t p = 0; p < kProbes; p++) fold(block->hist[p], r.retired[p]);
+        clear(*block);
+        r.live.erase(std::find(r.live.begin(), r.live.end(), block));
+        r.free.push_back(block);
+        tls_block = nullptr;
+        tls_exited = true;
+    }
+};
+
+// nullptr once the calling thread is tearing down
+ThreadBlock* acquire_block() {
+    if (tls_exited) return nullptr;
+    thread_local BlockLease lease;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    if (r.free.empty()) {
+        r.owned.push_back(std::make_unique<ThreadBlock>());
+        r.free.push_back(r.owned.back().get());
+    }
+    lease.block = tls_block = r.free.back();
+    r.free.pop_back();
+    r.live.push_back(tls_block);
+    return tls_block;
+}
+
+// Single writer: a plain load + store avoids a locked read-modify-write
+inline void bump(std::atomic<uint64_t>& a, uint64_t by) {
+    a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// ---------------- Metrics ----------------
+
+const char* Metrics::probe_name(Probe p) {
+    switch (p) {
+    case Probe::ProducerWait:     return "producer_wait";
+    case Probe::ConsumerWait:     return "consumer_wait";
+    case Probe::RequestResources: return "request_resources";
+    case Probe::RequestBatch:     return "request_batch";
+    case Probe::SafetyCheck:      return "safety_check";
+    case Probe::Schedule:         return "schedule";
+    case Probe::DeadlockDetect:   return "deadlock_detect";
+    case Probe::Count:            break;
+    }
+    return "?";
+}
+
+void Metrics::record(Probe p, uint64_t ns) {
+    ThreadBlock* block = tls_block;
+    if (!block && !(block = acquire_block())) {
+        // Recorded from a thread_local destructor after the lease was returned
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.retired[static_cast<size_t>(p)].record(ns);
+        return;
+    }
+    ThreadBlock::Hist& h = block->hist[static_cast<size_t>(p)];
+    bump(h.buckets[LatencyHistogram::bucket_of(ns)], 1);
+    bump(h.count, 1);
+    bump(h.sum, ns);
+    if (ns > h.max.load(std::memory_order_relaxed)) h.max.store(ns, std::memory_order_relaxed);
+}
+
+std::vector<LatencyHistogram> Metrics::merged() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    std::vector<LatencyHistogram> out = r.retired;
+    for (ThreadBlock* block : r.live)
+        for (size_t p = 0; p < kProbes; p++) fold(block->hist[p], out[p]);
+    return out;
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot snap;
+    auto hists = merged();
+    for (size_t p = 0; p < kProbes; p++) {
+        const LatencyHistogram& h = hists[p];
+        Probe probe = static_cast<Probe>(p);
+        double mean = h.count() ? static_cast<double>(h.sum()) / h.count() : 0.0;
+        snap.probes.push_back({probe, probe_name(probe), h.count(), mean,
+                               h.percentile(0.50), h.percentile(0.99), h.percentile(0.999), h.max()});
+    }
+    return snap;
+}
+
+void Metrics::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    for (ThreadBlock* block : r.live) clear(*block);
+    r.retired.assign(kProbes, LatencyHistogram{});
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Hot-path latency probes. Every thread records into its own block of
+// histograms (single writer, relaxed atomics, no locks), and snapshot()
+// merges all blocks on demand. A record costs two clock reads and a few
+// uncontended stores, so probes stay on in normal runs. Building with
+// -DMOS_NO_METRICS compiles ScopedLatency away entirely.
+
+enum class Probe {
+    ProducerWait,      // producer asleep on a full ready buffer
+    ConsumerWait,      // consumer asleep on an empty ready buffer
+    RequestResources,  // Bankers::request_resources
+    RequestBatch,      // Bankers::request_batch
+    SafetyCheck,       // Bankers::safety_check
+    Schedule,          // Scheduler::run
+    DeadlockDetect,    // Bankers::detect_deadlock
+    Count
+};
+
+// Log-linear buckets over nanoseconds: exact below 16, then 16 buckets per
+// power of two (relative error < 6.25%)
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+    static size_t bucket_of(uint64_t ns);
+    static uint64_t bucket_upper(size_t b);  // largest value in bucket b
+
+    void record(uint64_t ns);
+    void merge(const LatencyHistogram& other);
+    // Merge of bucket counts already added to `buckets` by the caller
+    void merge_totals(uint64_t count, uint64_t sum, uint64_t max);
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t max() const { return max_; }
+    uint64_t percentile(double p) const;     // p in [0, 1]; 0 when empty
+
+    std::array<uint64_t, kBuckets> buckets{};
+
+private:
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t max_{0};
+};
+
+struct ProbeSummary {
+    Probe probe;
+    const char* name;
+    uint64_t count;
+    double mean_ns;
+    uint64_t p50_ns, p99_ns, p999_ns, max_ns;
+};
+
+struct MetricsSnapshot {
+    std::vector<ProbeSummary> probes;   // one per Probe, in enum order
+};
+
+class Metrics {
+public:
+    static const char* probe_name(Probe p);
+
+    // Adds one sample to the calling thread's histogram for p
+    static void record(Probe p, uint64_t ns);
+
+    // Merge of every thread's histograms (threads that exited included)
+    static std::vector<LatencyHistogram> merged();
+    static MetricsSnapshot snapshot();
+
+    // Zero all histograms. Samples recorded concurrently may survive.
+    static void reset();
+};
+
+// Records the lifetime of the scope under a probe
+#ifndef MOS_NO_METRICS
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Probe p) : probe_(p), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        Metrics::record(probe_, static_cast<uint64_t>(ns));
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Probe probe_;
+    std::chrono::steady_clock::time_point start_;
+};
+#else
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Probe) {}
+};
+#endif
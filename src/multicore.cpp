@@ -0,0 +1,197 @@
+#include "multicore.hpp"
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+struct Core {
+    std::deque<size_t> queue;  // waiting processes (indices into procs)
+    size_t running{kNone};
+    long long run_start{0};    // progress of the current slice starts here
+    long long slice_end{0};
+    bool open{false};          // dispatched onto an empty queue: no quantum cut yet
+    unsigned version{0};       // invalidates stale slice-end events
+};
+
+struct Event {
+    long long time;
+    int core;
+    unsigned version;
+};
+
+// Min-heap on (time, core)
+struct EventCmp {
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.time != b.time) return a.time > b.time;
+        return a.core > b.core;
+    }
+};
+
+} // namespace
+
+MultiCoreResult MultiCoreScheduler::run(std::vector<Process> procs, const MultiCoreConfig& cfg) {
+    if (cfg.cores <= 0) throw std::invalid_argument("cores must be > 0");
+    if (cfg.quantum <= 0) throw std::invalid_argument("quantum must be > 0");
+    if (cfg.migration_cost < 0 || cfg.remote_cost < 0 || cfg.cores_per_node < 0)
+        throw std::invalid_argument("migration costs and cores_per_node must be >= 0");
+
+    const int n_cores = cfg.cores;
+    const long long q = cfg.quantum;
+    const int per_node = cfg.cores_per_node == 0 ? n_cores : cfg.cores_per_node;
+
+    MultiCoreResult out;
+    out.cores.resize(n_cores);
+
+    // Arrival order; ties keep input order
+    std::vector<size_t> order(procs.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return procs[a].arrival_time < procs[b].arrival_time;
+    });
+
+    std::vector<long long> remaining(procs.size());
+    std::vector<int> last_core(procs.size(), -1);
+    for (size_t k = 0; k < procs.size(); k++) remaining[k] = procs[k].remaining_time;
+
+    std::vector<Core> cores(n_cores);
+    std::priority_queue<Event, std::vector<Event>, EventCmp> events;
+    int idle = n_cores;
+
+    auto schedule_end = [&](int c) {
+        Core& core = cores[c];
+        core.version++;
+        events.push({core.slice_end, c, core.version});
+    };
+
+    auto dispatch = [&](int c, long long t, size_t idx) {
+        Core& core = cores[c];
+        if (core.running == kNone) idle--;
+        core.running = idx;
+
+        long long warmup = 0;
+        if (last_core[idx] != -1 && last_core[idx] != c) {
+            warmup = last_core[idx] / per_node == c / per_node ? cfg.migration_cost : cfg.remote_cost;
+            out.migrations++;
+            out.cores[c].migration += warmup;
+        }
+        last_core[idx] = c;
+
+        Process& p = procs[idx];
+        core.run_start = t + warmup;
+        if (p.start_time == -1) p.start_time = static_cast<int>(core.run_start);
+        core.open = core.queue.empty();
+        core.slice_end = core.run_start + (core.open ? remaining[idx] : std::min(q, remaining[idx]));
+        schedule_end(c);
+    };
+
+    // Work was queued behind an open slice: end it at the first quantum boundary >= t
+    auto close_slice = [&](int c, long long t) {
+        Core& core = cores[c];
+        if (!core.open) return;
+        core.open = false;
+        long long k = t <= core.run_start ? 1 : (t - core.run_start + q - 1) / q;
+        long long boundary = core.run_start + k * q;
+        if (boundary < core.slice_end) {
+            core.slice_end = boundary;
+            schedule_end(c);
+        }
+    };
+
+    // Idle core c takes the newest waiting process of the longest queue,
+    // looking at its own node first
+    auto steal = [&](int c, long long t) {
+        int victim = -1;
+        for (int pass = 0; pass < 2 && victim == -1; pass++) {
+            size_t longest = 0;
+            for (int v = 0; v < n_cores; v++) {
+                if (v == c || cores[v].queue.size() <= longest) continue;
+                if (pass == 0 && v / per_node != c / per_node) continue;
+                longest = cores[v].queue.size();
+                victim = v;
+            }
+        }
+        if (victim == -1) return false;
+
+        size_t idx = cores[victim].queue.back();
+        cores[victim].queue.pop_back();
+        out.cores[c].steals++;
+        out.steals++;
+        dispatch(c, t, idx);
+        return true;
+    };
+
+    auto place = [&](size_t idx, long long t) {
+        int best = 0;
+        for (int c = 0; c < n_cores; c++) {
+            if (idle > 0) {
+                if (cores[c].running == kNone) { best = c; break; }
+            } else if (cores[c].queue.size() < cores[best].queue.size()) {
+                best = c;
+            }
+        }
+        if (cores[best].running == kNone) {
+            dispatch(best, t, idx);
+        } else {
+            cores[best].queue.push_back(idx);
+            close_slice(best, t);
+        }
+    };
+
+    auto record = [&](int c, size_t idx, long long start, long long end) {
+        auto& gantt = out.cores[c].gantt;
+        int pid = procs[idx].pid;
+        if (!gantt.empty() && gantt.back().pid == pid && gantt.back().end == start)
+            gantt.back().end = static_cast<int>(end);
+        else
+            gantt.push_back({pid, static_cast<int>(start), static_cast<int>(end)});
+    };
+
+    size_t i = 0;
+    long long t = 0;
+    while (i < order.size() || idle < n_cores) {
+        while (!events.empty() && events.top().version != cores[events.top().core].version) events.pop();
+        long long next_event = events.empty() ? std::numeric_limits<long long>::max() : events.top().time;
+
+        // Arrivals at time t are queued before slices ending at t are requeued
+        if (i < order.size() && procs[order[i]].arrival_time <= next_event) {
+            t = procs[order[i]].arrival_time;
+            while (i < order.size() && procs[order[i]].arrival_time == t) place(order[i++], t);
+            continue;
+        }
+
+        Event e = events.top();
+        events.pop();
+        t = e.time;
+        Core& core = cores[e.core];
+        size_t idx = core.running;
+
+        long long ran = t - core.run_start;
+        remaining[idx] -= ran;
+        out.cores[e.core].busy += ran;
+        if (ran > 0) record(e.core, idx, core.run_start, t);
+
+        if (remaining[idx] == 0) procs[idx].finish_time = static_cast<int>(t);
+        else core.queue.push_back(idx);
+
+        if (!core.queue.empty()) {
+            size_t next = core.queue.front();
+            core.queue.pop_front();
+            dispatch(e.core, t, next);
+        } else {
+            core.running = kNone;
+            idle++;
+            steal(e.core, t);
+        }
+    }
+
+    out.total.finish_time = static_cast<int>(t);
+    Scheduler::compute_stats(procs, out.total, cfg.detail);
+    for (auto& c : out.cores)
+        c.utilization = t > 0 ? static_cast<double>(c.busy) / t : 0.0;
+    return out;
+}
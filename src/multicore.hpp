@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include "process.hpp"
+#include "scheduler.hpp"
+
+// Round Robin on several CPUs. Every core has its own run queue; arrivals go
+// to an idle core, else to the shortest queue. A core whose queue runs dry
+// steals from the back of the longest queue, preferring cores of its own node.
+// A process that resumes on a different core than it last ran on pays a
+// warm-up cost before making progress (remote_cost across nodes).
+struct MultiCoreConfig {
+    int cores{4};
+    int quantum{4};
+    int migration_cost{1};     // same node
+    int remote_cost{4};        // different node
+    int cores_per_node{0};     // 0 => all cores share one node
+    StatsDetail detail{StatsDetail::Summary};
+};
+
+struct CoreSchedule {
+    std::vector<GanttSlice> gantt;
+    long long busy{0};         // time spent running processes
+    long long migration{0};    // time spent warming up migrated processes
+    double utilization{0};     // busy / makespan
+    size_t steals{0};          // processes taken from other queues
+};
+
+struct MultiCoreResult {
+    std::vector<CoreSchedule> cores;
+    ScheduleResult total;      // waiting/turnaround/averages/makespan; gantt is per core
+    size_t migrations{0};
+    size_t steals{0};
+};
+
+class MultiCoreScheduler {
+public:
+    // Event driven: cost is O(slices * log cores) plus an O(cores) scan per
+    // arrival and per steal. While a core's queue is empty its process runs
+    // on as one slice, cut back to a quantum boundary once work is queued.
+    static MultiCoreResult run(std::vector<Process> procs, const MultiCoreConfig& cfg);
+};
@@ -0,0 +1,253 @@
+#include "online.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "event_log.hpp"
+
+OnlineSimulator::OnlineSimulator(std::vector<int> available, const OnlineConfig& cfg)
+    : available_(std::move(available)), cfg_(cfg), banker_(available_), blocked_(available_.size()) {
+    switch (cfg_.policy) {
+    case SchedPolicy::Auto:
+    case SchedPolicy::RoundRobin:
+    case SchedPolicy::RoundRobinRounds: priority_ = false; break;
+    case SchedPolicy::Priority: priority_ = true; break;
+    default:
+        throw std::invalid_argument(std::string("online mode does not support policy ") +
+                                    Scheduler::policy_name(cfg_.policy) + " (use auto|rr|priority)");
+    }
+    if (cfg_.quantum <= 0) throw std::invalid_argument("quantum must be > 0");
+    if (cfg_.cpus < 1) throw std::invalid_argument("cpus must be >= 1");
+    blocked_.set_order(cfg_.wakeup);
+}
+
+void OnlineSimulator::enqueue(ProcessHandle h) {
+    if (!priority_) {
+        rr_queue_.push_back(h);
+        return;
+    }
+    prio_queue_.push_back({pool_[h].priority, seq_++, h});
+    std::push_heap(prio_queue_.begin(), prio_queue_.end(), std::greater<Ranked>());
+}
+
+bool OnlineSimulator::dequeue(ProcessHandle& h) {
+    if (!priority_) {
+        if (rr_queue_.empty()) return false;
+        h = rr_queue_.front();
+        rr_queue_.pop_front();
+        return true;
+    }
+    if (prio_queue_.empty()) return false;
+    std::pop_heap(prio_queue_.begin(), prio_queue_.end(), std::greater<Ranked>());
+    h = prio_queue_.back().h;
+    prio_queue_.pop_back();
+    return true;
+}
+
+void OnlineSimulator::admit(ProcessHandle h, long long now) {
+    tasks_[h].admitted_at = static_cast<int>(now);
+    enqueue(h);
+}
+
+int OnlineSimulator::cpu_until_io(ProcessHandle h) const {
+    const Process& p = pool_[h];
+    uint32_t next = tasks_[h].next_io;
+    if (next == p.io.size()) return p.remaining_time;
+    return p.io[next].at - (p.burst_time - p.remaining_time);
+}
+
+void OnlineSimulator::issue_io(ProcessHandle h, long long now, OnlineReport& r) {
+    const IoRequest& q = pool_[h].io[tasks_[h].next_io];
+    uint32_t d = static_cast<uint32_t>(q.device);
+    tasks_[h].io_since = static_cast<int>(now);
+    devices_[d].queue.push_back(h);
+    r.io_requests++;
+    r.max_io_queue = std::max(r.max_io_queue, devices_[d].queue.size());
+    if (devices_[d].queue.size() == 1) start_io(d, now);
+}
+
+void OnlineSimulator::start_io(uint32_t device, long long now) {
+    ProcessHandle h = devices_[device].queue.front();
+    io_wait_ += now - tasks_[h].io_since;
+    wheel_.schedule(now + pool_[h].io[tasks_[h].next_io].duration, {Event::IoDone, device});
+}
+
+void OnlineSimulator::arrive(ProcessHandle h, long long now, OnlineReport& r) {
+    const Process& p = pool_[h];
+    r.processes++;
+    EventLog::emit(EventType::Push, p.pid);
+
+    for (size_t i = 0; i < p.io.size(); i++) {
+        const IoRequest& q = p.io[i];
+        if (q.at <= (i ? p.io[i - 1].at : 0) || q.at >= p.burst_time || q.duration < 0 || q.device < 0)
+            throw std::invalid_argument("pid " + std::to_string(p.pid) +
+                                        ": I/O requests need 0 < at < burst in increasing order");
+        if (static_cast<size_t>(q.device) >= devices_.size()) devices_.resize(static_cast<size_t>(q.device) + 1);
+    }
+
+    // A claim above the total would stay registered and make every later
+    // state unsafe; it can never run, so it is not offered to the banker
+    bool feasible = p.max_need.size() == available_.size();
+    for (size_t j = 0; feasible && j < available_.size(); j++) feasible = p.max_need[j] <= available_[j];
+    if (!feasible) {
+        EventLog::emit(EventType::Block, p.pid);
+        r.stranded++;
+        return;
+    }
+
+    if (banker_.admit(p.pid, p.max_need)) {
+        EventLog::emit(EventType::Admit, p.pid);
+        admit(h, now);
+    } else {
+        // A waiting process holds nothing, and a claim within the total
+        // cannot make a state unsafe, so the banker only tracks admitted
+        // processes; that keeps every safety check small under backlog
+        banker_.release_all(p.pid);
+        EventLog::emit(EventType::Block, p.pid);
+        r.blocked++;
+        blocked_.add(h, pool_, banker_.available());
+    }
+}
+
+void OnlineSimulator::wake(long long now, OnlineReport& r) {
+    blocked_.take_fitting(pool_, banker_.available(), woken_);
+    for (const WakeupIndex::Entry& e : woken_) {
+        const Process& p = pool_[e.h];
+        if (banker_.admit(p.pid, p.max_need)) {
+            EventLog::emit(EventType::Unblock, p.pid);
+            r.unblocked++;
+            admit(e.h, now);
+        } else {
+            banker_.release_all(p.pid);
+            blocked_.readd(e, pool_, banker_.available());
+        }
+    }
+}
+
+void OnlineSimulator::dispatch(long long now, GanttSink* sink) {
+    for (size_t c = 0; c < cpus_.size(); c++) {
+        Cpu& cpu = cpus_[c];
+        if (cpu.running != kNoProcess) continue;
+        ProcessHandle h;
+        if (!dequeue(h)) return;
+
+        Process& p = pool_[h];
+        if (p.start_time < 0) p.start_time = static_cast<int>(now);
+        cpu.running = h;
+        cpu.slice = std::min(priority_ ? p.remaining_time : cfg_.quantum, cpu_until_io(h));
+        wheel_.schedule(now + cpu.slice, {Event::SliceEnd, static_cast<uint32_t>(c)});
+
+        int end = static_cast<int>(now + cpu.slice);
+        if (sink) sink->add(p.pid, static_cast<int>(now), end);
+        EventLog::emit(EventType::Slice, p.pid, static_cast<int>(now), end, static_cast<int>(c));
+    }
+}
+
+OnlineReport OnlineSimulator::run(TraceSource& src, GanttSink* sink) {
+    if (sink && cfg_.cpus != 1) throw std::invalid_argument("a Gantt sink needs a single-CPU run");
+    if (src.resources() != available_.size())
+        throw std::invalid_argument("trace has " + std::to_string(src.resources()) +
+                                    " resource types, available has " + std::to_string(available_.size()));
+
+    auto t0 = std::chrono::steady_clock::now();
+    OnlineReport r;
+    pool_.clear();
+    banker_ = Bankers(available_);
+    blocked_.clear();
+    wheel_.clear();
+    cpus_.assign(static_cast<size_t>(cfg_.cpus), Cpu{});
+    rr_queue_.clear();
+    prio_queue_.clear();
+    seq_ = 0;
+    tasks_.clear();
+    devices_.clear();
+    io_wait_ = 0;
+    requeue_.clear();
+
+    long double sum_wait = 0, sum_tat = 0, sum_delay = 0;
+
+    // One arrival from the source is pending in the wheel at a time
+    Process next;
+    bool have = src.next(next);
+    auto create_next = [&] {
+        ProcessHandle h = pool_.create(next);
+        tasks_.emplace_back();
+        have = src.next(next);
+        return h;
+    };
+    auto schedule_next = [&](long long at) {
+        ProcessHandle h = create_next();
+        wheel_.schedule(at, {Event::Arrival, h});
+    };
+    if (have) schedule_next(std::max(next.arrival_time, 0));
+
+    std::vector<Event> due;
+    long long now = 0;
+    while (wheel_.pop_next(due, now)) {
+        for (const Event& ev : due) {
+            r.events++;
+            if (ev.kind == Event::Arrival) {
+                arrive(ev.id, now, r);
+                // Everything else that has arrived by now joins before the dispatch
+                while (have && next.arrival_time <= now) {
+                    r.events++;
+                    arrive(create_next(), now, r);
+                }
+                if (have) schedule_next(next.arrival_time);
+                continue;
+            }
+            if (ev.kind == Event::IoDone) {
+                Device& dev = devices_[ev.id];
+                ProcessHandle h = dev.queue.front();
+                dev.queue.pop_front();
+                Task& t = tasks_[h];
+                t.io_time += static_cast<int>(now) - t.io_since;
+                t.next_io++;
+                requeue_.push_back(h);
+                if (!dev.queue.empty()) start_io(ev.id, now);
+                continue;
+            }
+
+            Cpu& cpu = cpus_[ev.id];
+            ProcessHandle h = cpu.running;
+            cpu.running = kNoProcess;
+            Process& p = pool_[h];
+            p.remaining_time -= cpu.slice;
+            if (p.remaining_time > 0) {
+                if (cpu_until_io(h) == 0) issue_io(h, now, r);
+                else requeue_.push_back(h);
+                continue;
+            }
+
+            p.finish_time = static_cast<int>(now);
+            int tat = p.finish_time - p.arrival_time;
+            int delay = tasks_[h].admitted_at - p.arrival_time;
+            sum_tat += tat;
+            sum_wait += tat - p.burst_time - tasks_[h].io_time;
+            sum_delay += delay;
+            r.max_turnaround = std::max(r.max_turnaround, tat);
+            r.max_admission_delay = std::max(r.max_admission_delay, delay);
+            if (p.deadline >= 0 && p.finish_time > p.deadline) r.deadline_misses++;
+            r.completed++;
+            r.makespan = now;
+
+            banker_.release_all(p.pid);
+            wake(now, r);
+        }
+        due.clear();
+        // Like Scheduler::round_robin: arrivals at this time queue ahead of the preempted
+        for (ProcessHandle h : requeue_) enqueue(h);
+        requeue_.clear();
+        dispatch(now, sink);
+    }
+    if (sink) sink->finish();
+
+    r.stranded += r.blocked - r.unblocked;
+    if (r.completed) {
+        r.avg_waiting = static_cast<double>(sum_wait / r.completed);
+        r.avg_turnaround = static_cast<double>(sum_tat / r.completed);
+        r.avg_admission_delay = static_cast<double>(sum_delay / r.completed);
+    }
+    if (r.io_requests) r.avg_io_wait = static_cast<double>(io_wait_) / r.io_requests;
+    r.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "bankers.hpp"
+#include "gantt.hpp"
+#include "process_pool.hpp"
+#include "scheduler.hpp"
+#include "timing_wheel.hpp"
+#include "trace.hpp"
+#include "wakeup_index.hpp"
+
+// Online discrete-event run: arrivals, admission, dispatch, completion and
+// release all happen on one simulated clock. A completion releases its
+// claim at once and wakes blocked processes that now fit, so they are
+// scheduled in the same run. Arrivals are read from the source as the
+// clock reaches them (sources should be in arrival order; a late arrival
+// is taken as arriving now).
+//
+// Processes with Process::io alternate CPU and I/O bursts. Each one is a
+// resumable task driven by the event loop, not a thread: a slice runs at
+// most to the next I/O point, the process then queues FIFO on its device
+// (keeping its claim), and the device's completion event makes it ready
+// again. The per-process state is a Task of four ints beside the pool
+// record, so millions of processes fit in one run.
+struct OnlineConfig {
+    SchedPolicy policy{SchedPolicy::RoundRobin};   // auto|rr|rr-rounds => RR, priority
+    int quantum{4};
+    int cpus{1};                                   // one shared run queue
+    WakeupOrder wakeup{WakeupOrder::Fifo};
+};
+
+struct OnlineReport {
+    size_t processes{0};
+    size_t completed{0};
+    size_t blocked{0};         // refused at arrival (unsafe or not available)
+    size_t unblocked{0};       // admitted later, after a release
+    size_t stranded{0};        // still blocked at the end (claim can never be met)
+    double avg_waiting{0};     // completion - arrival - burst - time in I/O
+    double avg_turnaround{0};  // completion - arrival
+    int max_turnaround{0};
+    double avg_admission_delay{0};  // admission - arrival
+    int max_admission_delay{0};
+    long long makespan{0};
+    int deadline_misses{0};
+    size_t io_requests{0};
+    double avg_io_wait{0};     // device queueing before service starts
+    size_t max_io_queue{0};    // longest device queue, the request in service included
+    size_t events{0};          // arrivals + slice ends + I/O completions processed
+    double wall_ms{0};
+};
+
+class OnlineSimulator {
+public:
+    // Throws invalid_argument for an unsupported policy, quantum or cpus < 1
+    OnlineSimulator(std::vector<int> available, const OnlineConfig& cfg);
+
+    // sink (single CPU only) receives the slices as they are dispatched
+    OnlineReport run(TraceSource& src, GanttSink* sink = nullptr);
+
+private:
+    struct Event {
+        enum Kind : uint8_t { Arrival, SliceEnd, IoDone } kind;
+        uint32_t id;   // Arrival: handle; SliceEnd: cpu; IoDone: device
+    };
+    struct Cpu {
+        ProcessHandle running{kNoProcess};
+        int slice{0};
+    };
+    // Where a process is in its CPU/I/O sequence, by handle
+    struct Task {
+        int admitted_at{-1};
+        uint32_t next_io{0};   // index into Process::io
+        int io_since{0};       // when the pending request was issued
+        int io_time{0};        // total time spent waiting for and in I/O
+    };
+    struct Device {
+        std::deque<ProcessHandle> queue;   // front is in service
+    };
+    // Priority run queue entry: lower priority number first, then arrival order
+    struct Ranked {
+        int priority;
+        uint64_t seq;
+        ProcessHandle h;
+        bool operator>(const Ranked& o) const {
+            return priority != o.priority ? priority > o.priority : seq > o.seq;
+        }
+    };
+
+    std::vector<int> available_;
+    OnlineConfig cfg_;
+    bool priority_{false};
+
+    // Per run
+    ProcessPool pool_;
+    Bankers banker_;
+    WakeupIndex blocked_;
+    TimingWheel<Event> wheel_;
+    std::vector<Cpu> cpus_;
+    std::deque<ProcessHandle> rr_queue_;
+    std::vector<Ranked> prio_queue_;        // min-heap
+    uint64_t seq_{0};
+    std::vector<Task> tasks_;               // by handle
+    std::vector<Device> devices_;           // grown to the highest device seen
+    long long io_wait_{0};
+    std::vector<WakeupIndex::Entry> woken_;
+    std::vector<ProcessHandle> requeue_;    // slice ended or I/O done at the current time
+
+    void enqueue(ProcessHandle h);
+    bool dequeue(ProcessHandle& h);
+    void arrive(ProcessHandle h, long long now, OnlineReport& r);
+    void admit(ProcessHandle h, long long now);
+    void wake(long long now, OnlineReport& r);
+    void dispatch(long long now, GanttSink* sink);
+    // CPU time h can run before its next I/O request (or to completion)
+    int cpu_until_io(ProcessHandle h) const;
+    void issue_io(ProcessHandle h, long long now, OnlineReport& r);
+    void start_io(uint32_t device, long long now);
+};
@@ -0,0 +1,831 @@
+#include "paging.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pid_map.hpp"
+#include "thread_pool.hpp"
+
+static const char kRefMagic[8] = {'M', 'O', 'S', 'M', 'R', 'E', 'F', 'S'};
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+constexpr uint64_t kNoKey = UINT64_MAX;   // no (row, page) pair uses it: pages are < kExitPage
+
+// (process row, virtual page) packed into one word
+inline uint64_t page_key(uint32_t row, uint32_t page) { return (uint64_t(row) << 32) | page; }
+inline uint32_t key_row(uint64_t key) { return static_cast<uint32_t>(key >> 32); }
+inline uint32_t key_page(uint64_t key) { return static_cast<uint32_t>(key); }
+
+inline uint64_t mix(uint64_t key) { return key * 0x9E3779B97F4A7C15ull; }
+
+// ---------------- building blocks ----------------
+
+// Doubly-linked lists threaded through nodes [0, nodes); list l is a ring
+// through the sentinel node nodes + l. Links of one node share a cache line.
+class LinkedLists {
+public:
+    LinkedLists(uint32_t nodes, uint32_t lists) : links_(nodes + lists), sizes_(lists), nodes_(nodes) {
+        for (uint32_t l = 0; l < lists; l++) links_[nodes + l] = {nodes + l, nodes + l};
+    }
+
+    void push_front(uint32_t l, uint32_t x) {
+        uint32_t head = nodes_ + l, next = links_[head].next;
+        links_[x] = {head, next};
+        links_[next].prev = x;
+        links_[head].next = x;
+        sizes_[l]++;
+    }
+
+    void unlink(uint32_t l, uint32_t x) {
+        Link k = links_[x];
+        links_[k.prev].next = k.next;
+        links_[k.next].prev = k.prev;
+        sizes_[l]--;
+    }
+
+    void move_to_front(uint32_t l, uint32_t x) {
+        if (links_[nodes_ + l].next == x) return;
+        unlink(l, x);
+        push_front(l, x);
+    }
+
+    // Least recently pushed node; only valid if !empty(l)
+    uint32_t back(uint32_t l) const { return links_[nodes_ + l].prev; }
+    bool empty(uint32_t l) const { return sizes_[l] == 0; }
+    uint32_t size(uint32_t l) const { return sizes_[l]; }
+
+private:
+    struct Link {
+        uint32_t prev, next;
+    };
+    std::vector<Link> links_;
+    std::vector<uint32_t> sizes_;
+    uint32_t nodes_;
+};
+
+// Fixed-capacity key -> node map, open addressing with linear probing and
+// backward-shift deletion (as PidRowMap, but for 64-bit keys and at most
+// `capacity` entries, so it never grows)
+class KeyIndex {
+public:
+    explicit KeyIndex(size_t capacity) {
+        size_t cap = 16;
+        while (cap < 2 * capacity) cap *= 2;
+        slots_.assign(cap, Slot{kNoKey, kNone});
+        mask_ = cap - 1;
+        shift_ = 64 - __builtin_ctzll(cap);
+    }
+
+    uint32_t find(uint64_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return slots_[i].node;
+            if (slots_[i].key == kNoKey) return kNone;
+        }
+    }
+
+    void insert(uint64_t key, uint32_t node) {
+        size_t i = home(key);
+        while (slots_[i].key != kNoKey) i = (i + 1) & mask_;
+        slots_[i] = {key, node};
+    }
+
+    void erase(uint64_t key) {
+        size_t i = home(key);
+        while (slots_[i].key != key) {
+            if (slots_[i].key == kNoKey) return;
+            i = (i + 1) & mask_;
+        }
+        for (size_t j = (i + 1) & mask_; slots_[j].key != kNoKey; j = (j + 1) & mask_) {
+            size_t h = home(slots_[j].key);
+            bool stays = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+            if (stays) continue;
+            slots_[i] = slots_[j];
+            i = j;
+        }
+        slots_[i].key = kNoKey;
+    }
+
+private:
+    struct Slot {
+        uint64_t key;
+        uint32_t node;
+    };
+    std::vector<Slot> slots_;
+    size_t mask_{0};
+    int shift_{64};
+
+    size_t home(uint64_t key) const { return static_cast<size_t>(mix(key) >> shift_); }
+};
+
+// Two-level page table of one process: page -> frame (kNone = not
+// resident). Leaves of kLeafPages entries are allocated on first touch.
+// The top level is a vector for the low kDenseLeaves leaves (at most 32 KB)
+// and an ordered map above, so a page near 2^32 costs one leaf, not a
+// vector of 2^22 leaf pointers. Residents are visited in page order.
+class PageTable {
+public:
+    static constexpr uint32_t kLeafBits = 10;
+    static constexpr uint32_t kLeafPages = 1u << kLeafBits;
+    static constexpr size_t kDenseLeaves = 4096;   // pages below 2^22
+
+    uint32_t& slot(uint32_t page) {
+        size_t leaf = page >> kLeafBits;
+        std::unique_ptr<uint32_t[]>* entry;
+        if (leaf < kDenseLeaves) {
+            if (leaf >= leaves_.size()) leaves_.resize(leaf + 1);
+            entry = &leaves_[leaf];
+        } else {
+            entry = &far_[static_cast<uint32_t>(leaf)];
+        }
+        if (!*entry) {
+            entry->reset(new uint32_t[kLeafPages]);
+            std::fill_n(entry->get(), kLeafPages, kNone);
+        }
+        return (*entry)[page & (kLeafPages - 1)];
+    }
+
+    // Entry of a page known to be resident
+    uint32_t& mapped(uint32_t page) {
+        size_t leaf = page >> kLeafBits;
+        uint32_t* entries = leaf < kDenseLeaves ? leaves_[leaf].get() : far_.find(static_cast<uint32_t>(leaf))->second.get();
+        return entries[page & (kLeafPages - 1)];
+    }
+
+    template <class F>
+    void for_each_resident(F&& fn) const {
+        auto visit = [&](const std::unique_ptr<uint32_t[]>& leaf) {
+            if (!leaf) return;
+            for (uint32_t i = 0; i < kLeafPages; i++)
+                if (leaf[i] != kNone) fn(leaf[i]);
+        };
+        for (const auto& leaf : leaves_) visit(leaf);
+        for (const auto& entry : far_) visit(entry.second);
+    }
+
+    void clear() {
+        leaves_.clear();
+        far_.clear();
+    }
+
+private:
+    std::vector<std::unique_ptr<uint32_t[]>> leaves_;
+    std::map<uint32_t, std::unique_ptr<uint32_t[]>> far_;
+};
+
+// Tree pseudo-LRU over 4 ways, as hardware TLBs do: bit 0 points to the
+// older pair, bit 1 / bit 2 to the older way within the left / right pair.
+// Both transitions are table lookups, so a hit in any way costs no branch.
+struct PlruTables {
+    uint8_t touch[8][4];   // state after using way w
+    uint8_t victim[8];
+};
+
+constexpr PlruTables make_plru() {
+    PlruTables t{};
+    for (uint32_t s = 0; s < 8; s++) {
+        for (uint32_t w = 0; w < 4; w++) {
+            uint32_t next = w < 2 ? (s | 1u) : (s & ~1u);
+            if (w < 2) next = w == 0 ? (next | 2u) : (next & ~2u);
+            else next = w == 2 ? (next | 4u) : (next & ~4u);
+            t.touch[s][w] = static_cast<uint8_t>(next);
+        }
+        t.victim[s] = static_cast<uint8_t>(!(s & 1u) ? ((s & 2u) ? 1 : 0) : ((s & 4u) ? 3 : 2));
+    }
+    return t;
+}
+
+constexpr PlruTables kPlru = make_plru();
+
+// 4-way set-associative TLB; the tags of a set share one 64-byte line
+class Tlb {
+public:
+    static constexpr uint32_t kWays = 4;
+
+    explicit Tlb(uint32_t entries) {
+        if (entries % kWays) throw std::invalid_argument("TLB entries must be a multiple of 4");
+        uint32_t sets = entries / kWays;
+        if (sets & (sets - 1)) throw std::invalid_argument("TLB sets (entries / 4) must be a power of two");
+        sets_.assign(sets, Set{});
+        mask_ = sets ? sets - 1 : 0;
+    }
+
+    bool enabled() const { return !sets_.empty(); }
+
+    uint32_t lookup(uint64_t key) {
+        Set& s = set_of(key);
+        uint32_t match = uint32_t(s.key[0] == key) | uint32_t(s.key[1] == key) << 1 |
+                         uint32_t(s.key[2] == key) << 2 | uint32_t(s.key[3] == key) << 3;
+        if (!match) return kNone;
+        uint32_t w = static_cast<uint32_t>(__builtin_ctz(match));
+        s.plru = kPlru.touch[s.plru][w];
+        return s.frame[w];
+    }
+
+    void insert(uint64_t key, uint32_t frame) {
+        Set& s = set_of(key);
+        uint32_t w = kPlru.victim[s.plru];
+        s.key[w] = key;
+        s.frame[w] = frame;
+        s.plru = kPlru.touch[s.plru][w];
+    }
+
+    void invalidate(uint64_t key) {
+        Set& s = set_of(key);
+        for (uint64_t& k : s.key)
+            if (k == key) k = kNoKey;
+    }
+
+private:
+    struct alignas(64) Set {
+        uint64_t key[kWays]{kNoKey, kNoKey, kNoKey, kNoKey};
+        uint32_t frame[kWays]{};
+        uint8_t plru{0};
+    };
+    std::vector<Set> sets_;
+    uint64_t mask_{0};
+
+    Set& set_of(uint64_t key) { return sets_[(mix(key) >> 32) & mask_]; }
+};
+
+// ---------------- replacement policies ----------------
+//
+// Required members (every call O(1), amortised for clock):
+//   Policy(uint32_t frames, const uint64_t* keys);  // keys[f] = page in frame f
+//   void hit(uint32_t f);                 // resident page referenced
+//   uint32_t evict(uint64_t key);         // all frames busy, key faulted: unlink a victim
+//   void load(uint32_t f, uint64_t key);  // key now resident in f
+//   void release(uint32_t f);             // frame freed by a process exit
+
+class FifoPolicy {
+public:
+    FifoPolicy(uint32_t frames, const uint64_t*) : order_(frames, 1) {}
+
+    void hit(uint32_t) {}
+    uint32_t evict(uint64_t) {
+        uint32_t f = order_.back(0);
+        order_.unlink(0, f);
+        return f;
+    }
+    void load(uint32_t f, uint64_t) { order_.push_front(0, f); }
+    void release(uint32_t f) { order_.unlink(0, f); }
+
+private:
+    LinkedLists order_;    // front = newest
+};
+
+class LruPolicy {
+public:
+    LruPolicy(uint32_t frames, const uint64_t*) : order_(frames, 1) {}
+
+    void hit(uint32_t f) { order_.move_to_front(0, f); }
+    uint32_t evict(uint64_t) {
+        uint32_t f = order_.back(0);
+        order_.unlink(0, f);
+        return f;
+    }
+    void load(uint32_t f, uint64_t) { order_.push_front(0, f); }
+    void release(uint32_t f) { order_.unlink(0, f); }
+
+private:
+    LinkedLists order_;    // front = most recently used
+};
+
+// Second chance: the hand clears set bits until it finds a clear one.
+// evict() only runs with every frame resident, so the sweep ends within
+// one turn.
+class ClockPolicy {
+public:
+    ClockPolicy(uint32_t frames, const uint64_t*) : referenced_(frames, 0) {}
+
+    void hit(uint32_t f) { referenced_[f] = 1; }
+    uint32_t evict(uint64_t) {
+        const uint32_t n = static_cast<uint32_t>(referenced_.size());
+        while (referenced_[hand_]) {
+            referenced_[hand_] = 0;
+            hand_ = hand_ + 1 == n ? 0 : hand_ + 1;
+        }
+        uint32_t f = hand_;
+        hand_ = hand_ + 1 == n ? 0 : hand_ + 1;
+        return f;
+    }
+    void load(uint32_t f, uint64_t) { referenced_[f] = 1; }
+    void release(uint32_t f) { referenced_[f] = 0; }
+
+private:
+    std::vector<uint8_t> referenced_;
+    uint32_t hand_{0};
+};
+
+// ARC: T1 holds pages seen once recently, T2 pages seen at least twice.
+// B1/B2 remember the keys last evicted from T1/T2 (no frames). A fault on
+// a B1 key grows the T1 target p, one on a B2 key shrinks it.
+class ArcPolicy {
+public:
+    ArcPolicy(uint32_t frames, const uint64_t* keys)
+        : c_(frames), keys_(keys), resident_(frames, 2), in_t2_(frames, 0),
+          ghosts_(frames, 2), ghost_key_(frames, kNoKey), ghost_in_b2_(frames, 0), ghost_index_(frames) {
+        free_ghosts_.reserve(frames);
+        for (uint32_t g = frames; g-- > 0;) free_ghosts_.push_back(g);
+    }
+
+    void hit(uint32_t f) {
+        if (in_t2_[f]) {
+            resident_.move_to_front(kT2, f);
+        } else {
+            resident_.unlink(kT1, f);
+            resident_.push_front(kT2, f);
+            in_t2_[f] = 1;
+        }
+    }
+
+    uint32_t evict(uint64_t key) {
+        classify(key);
+        if (pending_ == Pending::Miss) {
+            uint32_t t1 = resident_.size(kT1), b1 = ghosts_.size(kB1);
+            if (t1 + b1 >= c_) {
+                if (t1 < c_) {
+                    drop_ghost(ghosts_.back(kB1));
+                } else {
+                    // B1 is empty and T1 fills the cache: evict without a ghost
+                    uint32_t f = resident_.back(kT1);
+                    resident_.unlink(kT1, f);
+                    return f;
+                }
+            } else if (t1 + resident_.size(kT2) + b1 + ghosts_.size(kB2) >= 2 * c_) {
+                drop_ghost(ghosts_.back(kB2));
+            }
+        }
+        return replace(pending_ == Pending::InB2);
+    }
+
+    void load(uint32_t f, uint64_t key) {
+        classify(key);
+        bool frequent = pending_ != Pending::Miss;
+        resident_.push_front(frequent ? kT2 : kT1, f);
+        in_t2_[f] = frequent;
+        pending_ = Pending::None;
+    }
+
+    void release(uint32_t f) { resident_.unlink(in_t2_[f] ? kT2 : kT1, f); }
+
+private:
+    enum : uint32_t { kT1 = 0, kT2 = 1, kB1 = 0, kB2 = 1 };
+    enum class Pending { None, Miss, InB1, InB2 };
+
+    uint32_t c_;
+    const uint64_t* keys_;
+    LinkedLists resident_;             // T1, T2 over frames
+    std::vector<uint8_t> in_t2_;
+    LinkedLists ghosts_;               // B1, B2 over ghost nodes
+    std::vector<uint64_t> ghost_key_;
+    std::vector<uint8_t> ghost_in_b2_;
+    std::vector<uint32_t> free_ghosts_;
+    KeyIndex ghost_index_;             // key -> ghost node
+    uint32_t p_{0};                    // target size of T1
+    Pending pending_{Pending::None};   // classification of the faulting key
+
+    // Adapts p on a ghost hit and forgets the ghost; runs once per fault
+    void classify(uint64_t key) {
+        if (pending_ != Pending::None) return;
+        uint32_t g = ghost_index_.find(key);
+        if (g == kNone) {
+            pending_ = Pending::Miss;
+            return;
+        }
+        uint32_t b1 = ghosts_.size(kB1), b2 = ghosts_.size(kB2);
+        if (ghost_in_b2_[g]) {
+            uint32_t delta = std::max<uint32_t>(1, b1 / b2);
+            p_ = p_ > delta ? p_ - delta : 0;
+            pending_ = Pending::InB2;
+        } else {
+            uint32_t delta = std::max<uint32_t>(1, b2 / b1);
+            p_ = std::min(c_, p_ + delta);
+            pending_ = Pending::InB1;
+        }
+        drop_ghost(g);
+    }
+
+    uint32_t replace(bool in_b2) {
+        uint32_t t1 = resident_.size(kT1);
+        bool from_t1 = t1 > 0 && (t1 > p_ || (in_b2 && t1 == p_) || resident_.empty(kT2));
+        uint32_t list = from_t1 ? kT1 : kT2;
+        uint32_t f = resident_.back(list);
+        resident_.unlink(list, f);
+        add_ghost(from_t1 ? kB1 : kB2, keys_[f]);
+        return f;
+    }
+
+    void add_ghost(uint32_t list, uint64_t key) {
+        // Frames freed by exits can leave room in T1/T2 while the ghosts
+        // are full; the oldest ghost then makes way
+        if (free_ghosts_.empty()) drop_ghost(ghosts_.back(ghosts_.empty(kB2) ? kB1 : kB2));
+        uint32_t g = free_ghosts_.back();
+        free_ghosts_.pop_back();
+        ghosts_.push_front(list, g);
+        ghost_key_[g] = key;
+        ghost_in_b2_[g] = list == kB2;
+        ghost_index_.insert(key, g);
+    }
+
+    void drop_ghost(uint32_t g) {
+        ghosts_.unlink(ghost_in_b2_[g] ? kB2 : kB1, g);
+        ghost_index_.erase(ghost_key_[g]);
+        free_ghosts_.push_back(g);
+    }
+};
+
+// ---------------- the pager ----------------
+
+template <class Policy>
+class Pager {
+public:
+    explicit Pager(const PagingConfig& cfg)
+        : keys_(cfg.frames, kNoKey), policy_(cfg.frames, keys_.data()), tlb_(cfg.tlb_entries) {
+        free_.reserve(cfg.frames);
+        for (uint32_t f = cfg.frames; f-- > 0;) free_.push_back(f);
+    }
+
+    void run(const MemRef* refs, size_t n, PagingStats& st) {
+        int last_pid = -1;
+        uint32_t row = 0;
+        uint32_t repeat = 0;            // page of the previous reference,
+        bool repeat_hit = false;        // if that reference hit
+        const bool tlb = tlb_.enabled();
+        // Counted in locals: stores through the policy's byte arrays would
+        // otherwise force st back to memory on every reference
+        uint64_t tlb_hits = 0, exits = 0;
+        for (size_t i = 0; i < n; i++) {
+            const MemRef r = refs[i];
+            if (repeat_hit && r.page == repeat && r.pid == last_pid) {
+                // Hitting the page that just hit changes nothing: its TLB way
+                // and its place in the policy are already where a hit puts them
+                tlb_hits += tlb;
+                continue;
+            }
+            if (r.pid != last_pid || r.page == kExitPage || r.pid < 0) {
+                if (r.page == kExitPage) {
+                    exit(r.pid);
+                    exits++;
+                    last_pid = -1;
+                    repeat_hit = false;
+                    continue;
+                }
+                row = row_of(r.pid);
+                last_pid = r.pid;
+            }
+            const uint64_t key = page_key(row, r.page);
+            if (tlb) {
+                uint32_t f = tlb_.lookup(key);
+                if (f != kNone) {
+                    tlb_hits++;
+                    policy_.hit(f);
+                    repeat = r.page;
+                    repeat_hit = true;
+                    continue;
+                }
+            }
+            uint32_t& pte = tables_[row].slot(r.page);
+            if (pte == kNone) {
+                st.faults++;
+                pte = fault(key, st);
+                repeat_hit = false;   // the next reference is the page's first hit
+            } else {
+                policy_.hit(pte);
+                repeat = r.page;
+                repeat_hit = true;
+            }
+            if (tlb) tlb_.insert(key, pte);
+        }
+        st.references = n - exits;
+        st.tlb_hits = tlb_hits;
+        st.exits = exits;
+        st.processes = tables_.size();
+    }
+
+private:
+    std::vector<uint64_t> keys_;       // frame -> resident key, kNoKey if free
+    Policy policy_;
+    Tlb tlb_;
+    std::vector<uint32_t> free_;       // free frames, lowest on top
+    PidRowMap rows_;                   // live pid -> row of tables_
+    std::vector<PageTable> tables_;    // rows are never reused, so stale keys never match
+
+    uint32_t row_of(int pid) {
+        if (pid < 0) throw std::runtime_error("paging: negative pid " + std::to_string(pid));
+        size_t row = rows_.find(pid);
+        if (row != PidRowMap::npos) return static_cast<uint32_t>(row);
+        if (tables_.size() >= kNone) throw std::runtime_error("paging: too many processes");
+        rows_.insert_or_assign(pid, tables_.size());
+        tables_.emplace_back();
+        return static_cast<uint32_t>(tables_.size() - 1);
+    }
+
+    uint32_t fault(uint64_t key, PagingStats& st) {
+        uint32_t f;
+        if (!free_.empty()) {
+            f = free_.back();
+            free_.pop_back();
+        } else {
+            f = policy_.evict(key);
+            uint64_t old = keys_[f];
+            tables_[key_row(old)].mapped(key_page(old)) = kNone;
+            if (tlb_.enabled()) tlb_.invalidate(old);
+            st.evictions++;
+        }
+        keys_[f] = key;
+        policy_.load(f, key);
+        return f;
+    }
+
+    void exit(int pid) {
+        size_t row = rows_.find(pid);
+        if (row == PidRowMap::npos) return;
+        tables_[row].for_each_resident([&](uint32_t f) {
+            policy_.release(f);
+            if (tlb_.enabled()) tlb_.invalidate(keys_[f]);
+            keys_[f] = kNoKey;
+            free_.push_back(f);
+        });
+        tables_[row].clear();
+        rows_.erase(pid);
+    }
+};
+
+template <class Policy>
+void replay(const MemRef* refs, size_t n, const PagingConfig& cfg, PagingStats& st) {
+    Pager<Policy> pager(cfg);
+    pager.run(refs, n, st);
+}
+
+// ---------------- reference generator ----------------
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// xoshiro256++
+class Rng {
+public:
+    explicit Rng(uint64_t seed) {
+        for (uint64_t& w : s_) w = splitmix64(seed);
+    }
+
+    uint64_t next() {
+        uint64_t r = rotl(s_[0] + s_[3], 23) + s_[0];
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return r;
+    }
+
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    // [0, n)
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+
+private:
+    uint64_t s_[4];
+};
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) parts.push_back(item);
+    return parts;
+}
+
+double to_double(const std::string& key, const std::string& v) {
+    size_t used = 0;
+    double d = std::stod(v, &used);
+    if (used != v.size()) throw std::invalid_argument("refs " + key + ": bad number " + v);
+    return d;
+}
+
+long long to_int(const std::string& key, const std::string& v) {
+    size_t used = 0;
+    long long x = std::stoll(v, &used);
+    if (used != v.size() || x < 0) throw std::invalid_argument("refs " + key + ": bad integer " + v);
+    return x;
+}
+
+void check(bool ok, const char* what) {
+    if (!ok) throw std::invalid_argument(std::string("refs: ") + what);
+}
+
+} // namespace
+
+// ---------------- RefTrace ----------------
+
+RefTrace::RefTrace(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open reference trace " + path + ": " + std::strerror(errno));
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat reference trace " + path);
+    }
+    map_len_ = static_cast<size_t>(st.st_size);
+    if (map_len_ < sizeof(RefTraceHeader)) {
+        ::close(fd);
+        throw std::runtime_error("reference trace too small: " + path);
+    }
+
+    map_ = mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        throw std::runtime_error("mmap failed for reference trace " + path);
+    }
+    // Every configuration streams the records front to back
+    madvise(map_, map_len_, MADV_SEQUENTIAL);
+
+    RefTraceHeader h;
+    std::memcpy(&h, map_, sizeof h);
+    if (std::memcmp(h.magic, kRefMagic, sizeof kRefMagic) != 0 || h.version != kRefTraceVersion) {
+        munmap(map_, map_len_);
+        throw std::runtime_error("not a version " + std::to_string(kRefTraceVersion) + " reference trace: " + path);
+    }
+    if (h.count > (map_len_ - sizeof h) / sizeof(MemRef)) {
+        munmap(map_, map_len_);
+        throw std::runtime_error("truncated reference trace: " + path);
+    }
+    count_ = h.count;
+    refs_ = reinterpret_cast<const MemRef*>(static_cast<const char*>(map_) + sizeof h);
+}
+
+RefTrace::~RefTrace() {
+    if (map_) munmap(map_, map_len_);
+}
+
+// ---------------- generator ----------------
+
+RefConfig parse_ref_spec(const std::string& spec) {
+    RefConfig cfg;
+    for (const std::string& item : split(spec, ',')) {
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) throw std::invalid_argument("refs: expected key=value, got " + item);
+        std::string key = item.substr(0, eq), v = item.substr(eq + 1);
+
+        if (key == "n") cfg.count = static_cast<uint64_t>(to_int(key, v));
+        else if (key == "seed") cfg.seed = static_cast<uint64_t>(to_int(key, v));
+        else if (key == "procs") cfg.processes = static_cast<int>(to_int(key, v));
+        else if (key == "pages") cfg.pages = static_cast<uint32_t>(to_int(key, v));
+        else if (key == "hot") cfg.hot = static_cast<uint32_t>(to_int(key, v));
+        else if (key == "hot-prob") cfg.hot_prob = to_double(key, v);
+        else if (key == "phase") cfg.phase = static_cast<uint64_t>(to_int(key, v));
+        else if (key == "run") cfg.run = to_double(key, v);
+        else if (key == "scan") cfg.scan = to_double(key, v);
+        else if (key == "repeat") cfg.repeat = to_double(key, v);
+        else if (key == "life") cfg.life = static_cast<uint64_t>(to_int(key, v));
+        else throw std::invalid_argument("refs: unknown key " + key);
+    }
+    return cfg;
+}
+
+size_t write_ref_trace(const std::string& path, const RefConfig& cfg) {
+    check(cfg.processes >= 1, "procs must be >= 1");
+    check(cfg.pages >= 1 && cfg.pages < kExitPage, "pages must be in [1, 2^32 - 1)");
+    check(cfg.hot >= 1 && cfg.hot <= cfg.pages, "hot must be in [1, pages]");
+    check(cfg.hot_prob >= 0 && cfg.hot_prob <= 1, "hot-prob must be in [0, 1]");
+    check(cfg.scan >= 0 && cfg.scan <= 1, "scan must be in [0, 1]");
+    check(cfg.phase >= 1 && cfg.run >= 1 && cfg.repeat >= 1, "phase, run and repeat must be >= 1");
+
+    struct Proc {
+        int pid;
+        uint32_t hot_base;
+        uint64_t done;       // references so far
+    };
+    Rng rng(cfg.seed);
+    std::vector<Proc> procs(static_cast<size_t>(cfg.processes));
+    int next_pid = 1;
+    for (Proc& p : procs) p = {next_pid++, rng.below(cfg.pages), 0};
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("cannot create " + path);
+    RefTraceHeader h{};
+    std::memcpy(h.magic, kRefMagic, sizeof kRefMagic);
+    h.version = kRefTraceVersion;
+    h.page_bits = 12;
+    h.count = cfg.count;
+    std::fwrite(&h, sizeof h, 1, f);
+
+    constexpr size_t kBlock = 1 << 16;
+    std::vector<MemRef> block;
+    block.reserve(kBlock);
+    auto emit = [&](int pid, uint32_t page) {
+        block.push_back({pid, page});
+        if (block.size() == kBlock) {
+            std::fwrite(block.data(), sizeof(MemRef), block.size(), f);
+            block.clear();
+        }
+    };
+
+    const double repeat_p = 1.0 / cfg.repeat;
+    uint64_t written = 0;
+    while (written < cfg.count) {
+        Proc& p = procs[rng.below(static_cast<uint32_t>(procs.size()))];
+        // Exponential run length, at least one reference
+        uint64_t run = 1 + static_cast<uint64_t>(-std::log1p(-rng.uniform()) * (cfg.run - 1));
+        bool scan = rng.uniform() < cfg.scan;
+        uint32_t page = rng.below(cfg.pages);
+        uint64_t same = 0;   // references left on the current page
+        for (uint64_t k = 0; k < run && written < cfg.count; k++) {
+            if (cfg.life && p.done >= cfg.life) {
+                emit(p.pid, kExitPage);
+                written++;
+                p = {next_pid++, rng.below(cfg.pages), 0};
+                break;
+            }
+            if (same == 0) {
+                if (scan) {
+                    page = page + 1 == cfg.pages ? 0 : page + 1;
+                } else if (rng.uniform() < cfg.hot_prob) {
+                    uint32_t off = rng.below(cfg.hot);
+                    page = cfg.pages - p.hot_base > off ? p.hot_base + off : off - (cfg.pages - p.hot_base);
+                } else {
+                    page = rng.below(cfg.pages);
+                }
+                // Geometric, mean `repeat`
+                same = repeat_p >= 1 ? 1 : 1 + static_cast<uint64_t>(std::log1p(-rng.uniform()) / std::log1p(-repeat_p));
+            }
+            same--;
+            emit(p.pid, page);
+            written++;
+            if (++p.done % cfg.phase == 0) p.hot_base = rng.below(cfg.pages);
+        }
+    }
+    std::fwrite(block.data(), sizeof(MemRef), block.size(), f);
+    bool ok = std::ferror(f) == 0;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) throw std::runtime_error("write failed for " + path);
+    return static_cast<size_t>(written);
+}
+
+// ---------------- replay ----------------
+
+Replacement parse_replacement(const std::string& name) {
+    if (name == "fifo") return Replacement::Fifo;
+    if (name == "lru") return Replacement::Lru;
+    if (name == "clock") return Replacement::Clock;
+    if (name == "arc") return Replacement::Arc;
+    throw std::invalid_argument("unknown replacement policy " + name);
+}
+
+const char* replacement_name(Replacement r) {
+    switch (r) {
+    case Replacement::Fifo:  return "fifo";
+    case Replacement::Lru:   return "lru";
+    case Replacement::Clock: return "clock";
+    case Replacement::Arc:   return "arc";
+    }
+    return "?";
+}
+
+PagingStats simulate_paging(const MemRef* refs, size_t n, const PagingConfig& cfg) {
+    if (cfg.frames == 0 || cfg.frames >= kNone) throw std::invalid_argument("frames must be in [1, 2^32 - 1)");
+
+    auto t0 = std::chrono::steady_clock::now();
+    PagingStats st;
+    st.config = cfg;
+    switch (cfg.policy) {
+    case Replacement::Fifo:  replay<FifoPolicy>(refs, n, cfg, st); break;
+    case Replacement::Lru:   replay<LruPolicy>(refs, n, cfg, st); break;
+    case Replacement::Clock: replay<ClockPolicy>(refs, n, cfg, st); break;
+    case Replacement::Arc:   replay<ArcPolicy>(refs, n, cfg, st); break;
+    }
+    st.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return st;
+}
+
+std::vector<PagingStats> run_paging(const RefTrace& trace, const std::vector<PagingConfig>& configs,
+                                    unsigned threads) {
+    std::vector<PagingStats> out(configs.size());
+    WorkStealingPool pool(threads);
+    pool.parallel_for(configs.size(), [&](size_t i) {
+        out[i] = simulate_paging(trace.data(), trace.size(), configs[i]);
+    });
+    return out;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Demand paging over memory-reference traces.
+//
+// Every process (keyed by pid) gets its own two-level page table. A small
+// set-associative TLB sits in front of them. Frames are shared by all
+// processes and replaced by one of four policies, each O(1) per reference:
+//   fifo   frames in one intrusive list, in load order
+//   lru    the same list, with a hit moving the frame to the front
+//   clock  one reference bit per frame and a sweeping hand
+//   arc    Adaptive Replacement Cache (Megiddo & Modha): recency and
+//          frequency lists plus ghost lists in a flat hash table
+//
+// Reference trace layout: RefTraceHeader, then `count` MemRef records in
+// host byte order. The file is memory-mapped and read in place.
+
+constexpr uint32_t kRefTraceVersion = 1;
+
+// page == kExitPage: the process exits and its frames are freed
+constexpr uint32_t kExitPage = UINT32_MAX;
+
+struct RefTraceHeader {
+    char magic[8];       // "MOSMREFS"
+    uint32_t version;    // kRefTraceVersion
+    uint32_t page_bits;  // log2 of the page size the trace was made for (informational)
+    uint64_t count;      // records
+};
+
+struct MemRef {
+    int32_t pid;         // >= 0
+    uint32_t page;       // virtual page number
+};
+
+// Read-only mapping of a reference trace
+class RefTrace {
+public:
+    explicit RefTrace(const std::string& path); // throws runtime_error
+    ~RefTrace();
+
+    RefTrace(const RefTrace&) = delete;
+    RefTrace& operator=(const RefTrace&) = delete;
+
+    const MemRef* data() const { return refs_; }
+    size_t size() const { return count_; }
+
+private:
+    void* map_{nullptr};
+    size_t map_len_{0};
+    const MemRef* refs_{nullptr};
+    size_t count_{0};
+};
+
+// Seeded synthetic references. Processes take turns in runs of about `run`
+// references; within a run a process touches its hot set with probability
+// hot_prob and any of its `pages` otherwise, or, with probability `scan`,
+// the run is a sequential scan instead. Each page picked is referenced
+// about `repeat` times in a row (accesses within one page). The hot set
+// moves every `phase` references of that process. With life > 0 a process
+// exits after `life` references and a new pid takes its place.
+struct RefConfig {
+    uint64_t seed{1};
+    uint64_t count{1000000};
+    int processes{8};
+    uint32_t pages{4096};        // address space per process
+    uint32_t hot{64};            // hot set size
+    double hot_prob{0.9};
+    uint64_t phase{100000};
+    double run{1000};            // mean references per scheduling run
+    double scan{0.05};
+    double repeat{4};            // mean consecutive references per page
+    uint64_t life{0};
+};
+
+// "key=value,..." with keys n, seed, procs, pages, hot, hot-prob, phase, run,
+// scan, repeat, life. Throws invalid_argument on an unknown key or a bad value.
+RefConfig parse_ref_spec(const std::string& spec);
+
+// Writes a generated trace; returns the number of records
+size_t write_ref_trace(const std::string& path, const RefConfig& cfg);
+
+enum class Replacement { Fifo, Lru, Clock, Arc };
+
+Replacement parse_replacement(const std::string& name); // throws invalid_argument
+const char* replacement_name(Replacement r);
+
+struct PagingConfig {
+    Replacement policy{Replacement::Lru};
+    uint32_t frames{1024};
+    uint32_t tlb_entries{64};    // multiple of 4 (4-way sets), 0 => no TLB
+};
+
+struct PagingStats {
+    PagingConfig config;
+    uint64_t references{0};
+    uint64_t faults{0};
+    uint64_t evictions{0};
+    uint64_t tlb_hits{0};
+    uint64_t exits{0};
+    size_t processes{0};         // distinct pids seen
+    double ms{0};
+
+    double fault_rate() const { return references ? double(faults) / double(references) : 0.0; }
+    double tlb_hit_rate() const { return references ? double(tlb_hits) / double(references) : 0.0; }
+};
+
+// Replays refs[0, n) through one configuration
+PagingStats simulate_paging(const MemRef* refs, size_t n, const PagingConfig& cfg);
+
+// Replays the trace through every configuration, spread over a
+// work-stealing pool (threads = 0 => one per core). Results in input order.
+std::vector<PagingStats> run_paging(const RefTrace& trace, const std::vector<PagingConfig>& configs,
+                                    unsigned threads = 0);
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// pid -> row index, open addressing with linear probing. Unlike
+// std::unordered_map it allocates only when the table grows, so admitting
+// and releasing processes in steady state never calls the allocator.
+class PidRowMap {
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    size_t find(int pid) const {
+        if (slots_.empty()) return npos;
+        for (size_t i = home(pid);; i = (i + 1) & mask_) {
+            const Slot& s = slots_[i];
+            if (s.row == npos) return npos;
+            if (s.pid == pid) return s.row;
+        }
+    }
+
+    bool contains(int pid) const { return find(pid) != npos; }
+
+    void insert_or_assign(int pid, size_t row) {
+        if (2 * (size_ + 1) > slots_.size()) grow();
+        size_t i = home(pid);
+        while (slots_[i].row != npos && slots_[i].pid != pid) i = (i + 1) & mask_;
+        if (slots_[i].row == npos) size_++;
+        slots_[i] = {pid, row};
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    bool erase(int pid) {
+        if (slots_.empty()) return false;
+        size_t i = home(pid);
+        while (slots_[i].row != npos && slots_[i].pid != pid) i = (i + 1) & mask_;
+        if (slots_[i].row == npos) return false;
+
+        for (size_t j = (i + 1) & mask_; slots_[j].row != npos; j = (j + 1) & mask_) {
+            size_t h = home(slots_[j].pid);
+            // Move j into the hole unless its home lies cyclically in (i, j]
+            bool stays = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+            if (stays) continue;
+            slots_[i] = slots_[j];
+            i = j;
+        }
+        slots_[i].row = npos;
+        size_--;
+        return true;
+    }
+
+    size_t size() const { return size_; }
+
+    // Sizes the table for n pids up front (e.g. before a bulk load)
+    void reserve(size_t n) {
+        while (2 * n > slots_.size()) grow();
+    }
+
+private:
+    struct Slot {
+        int pid;
+        size_t row;       // npos => empty
+    };
+    std::vector<Slot> slots_;
+    size_t mask_{0};
+    size_t size_{0};
+    int shift_{64};
+
+    size_t home(int pid) const {
+        // Fibonacci hashing spreads consecutive pids across the table
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(pid)) *
+                                    0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        size_t cap = old.empty() ? 64 : 2 * old.size();
+        slots_.assign(cap, Slot{0, npos});
+        mask_ = cap - 1;
+        shift_ = 64;
+        for (size_t c = cap; c > 1; c >>= 1) shift_--;
+        size_ = 0;
+        for (const Slot& s : old)
+            if (s.row != npos) insert_or_assign(s.pid, s.row);
+    }
+};
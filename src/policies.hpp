@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include "gantt.hpp"
+#include "process.hpp"
+#include "scheduler.hpp"
+
+// Scheduling policies for Scheduler::simulate<Policy>. A policy only owns the
+// ready set; the event loop (arrivals, clock, Gantt, stats) is shared and is
+// instantiated once per policy type; everything here is defined inline so
+// those calls are inlined into the loop.
+//
+// Required members:
+//   Policy(const std::vector<Process>& procs, int quantum);
+//   void push(size_t idx, long long t);         // procs[idx] became ready at t
+//   bool empty() const;
+//   size_t pick(long long t);                    // remove and return the next to run
+//   long long slice(size_t idx) const;           // max run before deciding again (>= 1)
+//   bool preempt_on_arrival(size_t idx) const;   // cut the run at the next arrival
+//   void ran(size_t idx, long long amount);      // account a finished run
+
+// Shortest Remaining Time First (preemptive SJF)
+class SrtfPolicy {
+public:
+    SrtfPolicy(const std::vector<Process>& procs, int quantum);
+
+    void push(size_t idx, long long t);
+    bool empty() const { return ready_.empty(); }
+    size_t pick(long long t);
+    long long slice(size_t idx) const { return procs_[idx].remaining_time; }
+    bool preempt_on_arrival(size_t) const { return true; }
+    void ran(size_t, long long) {}
+
+private:
+    using Entry = std::tuple<long long, uint64_t, size_t>; // remaining, push order, idx
+    const std::vector<Process>& procs_;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> ready_;
+    uint64_t seq_{0};
+};
+
+// Multi-level feedback queue. Level l runs Round Robin with quantum q << l;
+// using a full quantum demotes a process, and a process that waited
+// kAgingQuanta * q in a lower level is promoted back to the top. Arrivals
+// preempt anything below the top level.
+class MlfqPolicy {
+public:
+    static constexpr int kLevels = 3;
+    static constexpr int kAgingQuanta = 16;
+
+    MlfqPolicy(const std::vector<Process>& procs, int quantum);
+
+    void push(size_t idx, long long t);
+    bool empty() const { return size_ == 0; }
+    size_t pick(long long t);
+    long long slice(size_t idx) const { return (quantum_ << level_[idx]) - used_[idx]; }
+    bool preempt_on_arrival(size_t idx) const { return level_[idx] > 0; }
+    void ran(size_t idx, long long amount);
+
+private:
+    struct Waiting { size_t idx; long long since; };
+    long long quantum_;
+    std::deque<Waiting> levels_[kLevels];
+    std::vector<int> level_;
+    std::vector<long long> used_;   // time used at the current level
+    size_t size_{0};
+};
+
+// CFS-like fair scheduling: the ready set is a balanced tree (std::set)
+// ordered by weighted virtual runtime; the leftmost process runs next.
+// Weights follow the Linux nice table with nice = clamp(priority, -20, 19),
+// and a slice is the weight's share of quantum * runnable processes.
+class CfsPolicy {
+public:
+    CfsPolicy(const std::vector<Process>& procs, int quantum);
+
+    void push(size_t idx, long long t);
+    bool empty() const { return tree_.empty(); }
+    size_t pick(long long t);
+    long long slice(size_t idx) const;
+    bool preempt_on_arrival(size_t) const { return false; }
+    void ran(size_t idx, long long amount);
+
+private:
+    using Entry = std::tuple<long long, uint64_t, size_t>; // vruntime, push order, idx
+    long long quantum_;
+    std::set<Entry> tree_;
+    std::vector<long long> vruntime_;  // scaled by kVScale / weight per time unit
+    std::vector<int> weight_;
+    std::vector<bool> placed_;
+    long long min_vruntime_{0};
+    long long ready_weight_{0};
+    uint64_t seq_{0};
+};
+
+// Earliest Deadline First, preemptive. Processes without a deadline
+// (deadline < 0) are due at arrival + burst.
+class EdfPolicy {
+public:
+    EdfPolicy(const std::vector<Process>& procs, int quantum);
+
+    void push(size_t idx, long long t);
+    bool empty() const { return ready_.empty(); }
+    size_t pick(long long t);
+    long long slice(size_t idx) const { return procs_[idx].remaining_time; }
+    bool preempt_on_arrival(size_t) const { return true; }
+    void ran(size_t, long long) {}
+
+private:
+    using Entry = std::tuple<long long, uint64_t, size_t>; // deadline, push order, idx
+    const std::vector<Process>& procs_;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> ready_;
+    uint64_t seq_{0};
+};
+
+// ---------------- SRTF ----------------
+
+inline SrtfPolicy::SrtfPolicy(const std::vector<Process>& procs, int) : procs_(procs) {}
+
+inline void SrtfPolicy::push(size_t idx, long long) {
+    ready_.emplace(procs_[idx].remaining_time, seq_++, idx);
+}
+
+inline size_t SrtfPolicy::pick(long long) {
+    size_t idx = std::get<2>(ready_.top());
+    ready_.pop();
+    return idx;
+}
+
+// ---------------- MLFQ ----------------
+
+inline MlfqPolicy::MlfqPolicy(const std::vector<Process>& procs, int quantum)
+    : quantum_(quantum), level_(procs.size(), 0), used_(procs.size(), 0) {}
+
+inline void MlfqPolicy::push(size_t idx, long long t) {
+    levels_[level_[idx]].push_back({idx, t});
+    size_++;
+}
+
+inline size_t MlfqPolicy::pick(long long t) {
+    // Each level is FIFO in `since`, so only the fronts can be due for aging
+    long long age = kAgingQuanta * quantum_;
+    for (int l = 1; l < kLevels; l++) {
+        while (!levels_[l].empty() && t - levels_[l].front().since >= age) {
+            size_t idx = levels_[l].front().idx;
+            levels_[l].pop_front();
+            level_[idx] = 0;
+            used_[idx] = 0;
+            levels_[0].push_back({idx, t});
+        }
+    }
+
+    for (auto& level : levels_) {
+        if (level.empty()) continue;
+        size_t idx = level.front().idx;
+        level.pop_front();
+        size_--;
+        return idx;
+    }
+    return 0; // unreachable: pick() is only called when !empty()
+}
+
+inline void MlfqPolicy::ran(size_t idx, long long amount) {
+    used_[idx] += amount;
+    if (used_[idx] >= (quantum_ << level_[idx])) {
+        level_[idx] = std::min(level_[idx] + 1, kLevels - 1);
+        used_[idx] = 0;
+    }
+}
+
+// ---------------- CFS ----------------
+
+namespace detail {
+
+// Linux sched_prio_to_weight, nice -20 .. 19
+inline constexpr int kNiceWeight[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,   335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,    36,    29,    23,    18,    15,
+};
+inline constexpr long long kNice0Weight = 1024;
+inline constexpr long long kVScale = 1 << 20;
+
+} // namespace detail
+
+inline CfsPolicy::CfsPolicy(const std::vector<Process>& procs, int quantum)
+    : quantum_(quantum), vruntime_(procs.size(), 0), weight_(procs.size()),
+      placed_(procs.size(), false) {
+    for (size_t k = 0; k < procs.size(); k++)
+        weight_[k] = detail::kNiceWeight[std::clamp(procs[k].priority, -20, 19) + 20];
+}
+
+inline void CfsPolicy::push(size_t idx, long long) {
+    // A new process starts at the current minimum so it cannot monopolise the CPU
+    if (!placed_[idx]) {
+        placed_[idx] = true;
+        vruntime_[idx] = min_vruntime_;
+    }
+    tree_.emplace(vruntime_[idx], seq_++, idx);
+    ready_weight_ += weight_[idx];
+}
+
+inline size_t CfsPolicy::pick(long long) {
+    auto it = tree_.begin();
+    size_t idx = std::get<2>(*it);
+    tree_.erase(it);
+    ready_weight_ -= weight_[idx];
+    min_vruntime_ = std::max(min_vruntime_, vruntime_[idx]);
+    return idx;
+}
+
+inline long long CfsPolicy::slice(size_t idx) const {
+    long long runnable = static_cast<long long>(tree_.size()) + 1;
+    long long s = quantum_ * runnable * weight_[idx] / (ready_weight_ + weight_[idx]);
+    return std::max(1LL, s);
+}
+
+inline void CfsPolicy::ran(size_t idx, long long amount) {
+    vruntime_[idx] += amount * (detail::kVScale * detail::kNice0Weight / weight_[idx]);
+}
+
+// ---------------- EDF ----------------
+
+inline EdfPolicy::EdfPolicy(const std::vector<Process>& procs, int) : procs_(procs) {}
+
+inline void EdfPolicy::push(size_t idx, long long) {
+    const Process& p = procs_[idx];
+    long long due = p.deadline >= 0 ? p.deadline
+                                    : static_cast<long long>(p.arrival_time) + p.burst_time;
+    ready_.emplace(due, seq_++, idx);
+}
+
+inline size_t EdfPolicy::pick(long long) {
+    size_t idx = std::get<2>(ready_.top());
+    ready_.pop();
+    return idx;
+}
+
+// ---------------- shared event loop ----------------
+
+template <class Policy>
+ScheduleResult Scheduler::simulate(std::vector<Process> procs, int quantum, GanttSink* sink, StatsDetail detail) {
+    if (quantum <= 0) throw std::invalid_argument("quantum must be > 0");
+    ScheduleResult out;
+
+    std::vector<size_t> order(procs.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return procs[a].arrival_time < procs[b].arrival_time;
+    });
+
+    Policy policy(procs, quantum);
+    long long t = 0;
+    size_t i = 0;
+
+    auto admit_arrivals = [&]() {
+        while (i < order.size() && procs[order[i]].arrival_time <= t) policy.push(order[i++], t);
+    };
+
+    while (i < order.size() || !policy.empty()) {
+        admit_arrivals();
+
+        if (policy.empty()) {
+            t = procs[order[i]].arrival_time;
+            continue;
+        }
+
+        size_t idx = policy.pick(t);
+        Process& p = procs[idx];
+        if (p.start_time == -1) p.start_time = static_cast<int>(t);
+
+        long long run = std::min<long long>(p.remaining_time, policy.slice(idx));
+        if (i < order.size() && policy.preempt_on_arrival(idx))
+            run = std::min<long long>(run, procs[order[i]].arrival_time - t);
+
+        long long start = t;
+        t += run;
+        p.remaining_time -= static_cast<int>(run);
+        policy.ran(idx, run);
+
+        // Extend the previous slice when the same process keeps the CPU
+        if (sink) {
+            sink->add(p.pid, static_cast<int>(start), static_cast<int>(t));
+        } else if (run > 0) {
+            if (!out.gantt.empty() && out.gantt.back().pid == p.pid && out.gantt.back().end == start)
+                out.gantt.back().end = static_cast<int>(t);
+            else
+                out.gantt.push_back({p.pid, static_cast<int>(start), static_cast<int>(t)});
+        }
+
+        // Arrivals during the run queue up before the preempted process
+        admit_arrivals();
+
+        if (p.remaining_time > 0) policy.push(idx, t);
+        else p.finish_time = static_cast<int>(t);
+    }
+
+    out.finish_time = static_cast<int>(t);
+    compute_stats(procs, out, detail);
+    return out;
+}
@@ -1,6 +1,15 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "resource_vector.hpp"
+
+// Blocking I/O: once `at` units of the process's CPU time have run, it
+// waits `duration` on `device` (FIFO per device) and then is ready again
+struct IoRequest {
+    int at;
+    int duration;
+    int device;
+};
 
 struct Process {
     int pid{};
@@ -8,8 +17,14 @@ struct Process {
     int burst_time{};
     int remaining_time{};     // for Round Robin
     int priority{};           // lower number = higher priority (we'll follow this convention)
+    int deadline{-1};         // absolute, for EDF; -1 => none
+
+    ResourceVector max_need;   // requested resources (R1..Rm) for this process
 
-    std::vector<int> max_need; // requested resources (R1..Rm) for this process
+    // CPU/I/O alternation, sorted by `at` with 0 < at < burst_time. Only the
+    // online engine (online.hpp) blocks on it; the phased schedulers see
+    // burst_time as one CPU burst.
+    std::vector<IoRequest> io;
 
     // Stats
     int start_time{-1};
@@ -17,7 +32,7 @@ struct Process {
 
     Process() = default;
 
-    Process(int id, int at, int bt, int pr, std::vector<int> need)
+    Process(int id, int at, int bt, int pr, ResourceVector need)
         : pid(id), arrival_time(at), burst_time(bt), remaining_time(bt),
           priority(pr), max_need(std::move(need)) {}
 };
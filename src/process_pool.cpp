@@ -0,0 +1,32 @@
+#include "process_pool.hpp"
+#include <stdexcept>
+
+ProcessHandle ProcessPool::next_handle() {
+    uint32_t h = next_.fetch_add(1, std::memory_order_relaxed);
+    if (h >= ChunkedStore<Process>::kCapacity) {
+        next_.fetch_sub(1, std::memory_order_relaxed);
+        throw std::length_error("process pool is full");
+    }
+    return h;
+}
+
+ProcessHandle ProcessPool::create(const Process& p) {
+    ProcessHandle h = next_handle();
+    records_.at_grow(h) = p;
+    return h;
+}
+
+ProcessHandle ProcessPool::create(Process&& p) {
+    ProcessHandle h = next_handle();
+    // Reused records are overwritten in place; inline claims do not allocate
+    records_.at_grow(h) = std::move(p);
+    return h;
+}
+
+void HandleList::clear() { truncate(0); }
+
+void HandleList::truncate(size_t n) {
+    size_t old = size();
+    for (size_t i = n; i < old; i++) slots_[i].store(0, std::memory_order_relaxed);
+    size_.store(n, std::memory_order_release);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include "chunked_store.hpp"
+#include "process.hpp"
+
+// Index of a Process inside a ProcessPool
+using ProcessHandle = uint32_t;
+constexpr ProcessHandle kNoProcess = UINT32_MAX;
+
+// Arena of Process records addressed by handle. Records are stored in
+// fixed-size chunks that never move, so a handle stays valid (and cheap to
+// pass through queues) until clear(). create() is a lock-free bump of the
+// next index; only the first record of a new chunk takes a lock. clear()
+// keeps the chunks, so a pool reused across runs stops allocating.
+class ProcessPool {
+public:
+    static constexpr size_t kCapacity = ChunkedStore<Process>::kCapacity;
+
+    // Thread-safe; throws length_error when the pool is full. Copying into a
+    // reused record keeps its claim storage, so even spilled claims stop
+    // allocating once the pool has warmed up.
+    ProcessHandle create(const Process& p);
+    ProcessHandle create(Process&& p);
+
+    Process& operator[](ProcessHandle h) { return records_[h]; }
+    const Process& operator[](ProcessHandle h) const { return records_[h]; }
+
+    size_t size() const { return next_.load(std::memory_order_acquire); }
+
+    // Invalidates every handle. Not safe concurrently with create().
+    void clear() { next_.store(0, std::memory_order_release); }
+
+private:
+    std::atomic<uint32_t> next_{0};
+    ChunkedStore<Process> records_;
+
+    ProcessHandle next_handle();
+};
+
+// Append-only list of handles that any number of threads may push to
+// without locking (the ready/blocked lists of the dispatchers). Entries
+// never move; a reader sees size() slots, and one whose writer has not
+// finished yet reads as kNoProcess.
+class HandleList {
+public:
+    static constexpr size_t kCapacity = ChunkedStore<std::atomic<uint32_t>>::kCapacity;
+
+    void push_back(ProcessHandle h) {
+        size_t i = size_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= kCapacity) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            throw std::length_error("handle list is full");
+        }
+        slots_.at_grow(i).store(h + 1, std::memory_order_release);
+    }
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    ProcessHandle operator[](size_t i) const {
+        return slots_[i].load(std::memory_order_acquire) - 1;
+    }
+
+    // Published entries in list order
+    template <class F>
+    void for_each(F&& f) const {
+        size_t n = size();
+        for (size_t i = 0; i < n; i++) {
+            ProcessHandle h = (*this)[i];
+            if (h != kNoProcess) f(h);
+        }
+    }
+
+    // Single-threaded only (no concurrent push_back)
+    void clear();
+    // Keeps the entries for which keep(h) is true, in order
+    template <class Keep>
+    void retain_if(Keep&& keep) {
+        size_t n = size(), kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            ProcessHandle h = (*this)[i];
+            if (keep(h)) slots_[kept++].store(h + 1, std::memory_order_relaxed);
+        }
+        truncate(kept);
+    }
+
+private:
+    // Stored as handle + 1 so the zero-initialised chunks read as "not yet written"
+    using Slots = ChunkedStore<std::atomic<uint32_t>>;
+    Slots slots_;
+    std::atomic<size_t> size_{0};
+
+    void truncate(size_t n);
+};
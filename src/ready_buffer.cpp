@@ -1,49 +1,206 @@
 #include "ready_buffer.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include "metrics.hpp"
 
-ReadyBuffer::ReadyBuffer(size_t capacity)
-    : cap_(capacity), buf_(capacity)
+template <class T>
+ReadyRing<T>::ReadyRing(size_t capacity)
+    : cap_(capacity)
 {
     if (cap_ == 0) throw std::invalid_argument("capacity must be > 0");
 
-    // empty starts with capacity, full starts with 0
-    if (sem_init(&empty_, 0, static_cast<unsigned int>(cap_)) != 0)
-        throw std::runtime_error("sem_init(empty) failed");
-    if (sem_init(&full_, 0, 0) != 0)
-        throw std::runtime_error("sem_init(full) failed");
+    // slot i is free for the producer whose position is i. States are spaced
+    // by 2 (free = 2*pos, filled = 2*pos+1) so they stay distinct even for cap 1.
+    buf_.reset(new Slot[cap_]);
+    for (size_t i = 0; i < cap_; i++) buf_[i].seq.store(2 * i, std::memory_order_relaxed);
+
+    // both start at 0: they only carry wakeups, not slot counts
+    if (sem_init(&space_, 0, 0) != 0)
+        throw std::runtime_error("sem_init(space) failed");
+    if (sem_init(&items_, 0, 0) != 0)
+        throw std::runtime_error("sem_init(items) failed");
 }
 
-ReadyBuffer::~ReadyBuffer() {
-    sem_destroy(&empty_);
-    sem_destroy(&full_);
+template <class T>
+ReadyRing<T>::~ReadyRing() {
+    sem_destroy(&space_);
+    sem_destroy(&items_);
 }
 
-void ReadyBuffer::push(const Process& p) {
-    sem_wait(&empty_);
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        buf_[tail_] = p;
-        tail_ = (tail_ + 1) % cap_;
-        count_++; // NEW
+template <class T>
+typename ReadyRing<T>::Slot* ReadyRing<T>::claim_push(size_t& pos) {
+    pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& s = buf_[pos % cap_];
+        size_t seq = s.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq - 2 * pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return &s;
+        } else if (diff < 0) {
+            return nullptr; // slot still holds last lap's item => full
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
     }
-    sem_post(&full_);
 }
 
-Process ReadyBuffer::pop() {
-    sem_wait(&full_);
-    Process item;
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        item = buf_[head_];
-        head_ = (head_ + 1) % cap_;
-        count_--; // NEW
+template <class T>
+typename ReadyRing<T>::Slot* ReadyRing<T>::claim_pop(size_t& pos) {
+    pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& s = buf_[pos % cap_];
+        size_t seq = s.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq - (2 * pos + 1));
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return &s;
+        } else if (diff < 0) {
+            return nullptr; // not filled yet => empty
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Sleepers announce themselves, then re-check the ring. Wakers publish the
+// slot, then look for sleepers. The two seq_cst fences guarantee at least one
+// side sees the other, so no wakeup is lost.
+template <class T>
+void ReadyRing<T>::wait_for_space() {
+    push_waiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    size_t seq = buf_[pos % cap_].seq.load(std::memory_order_acquire);
+    if (static_cast<std::ptrdiff_t>(seq - 2 * pos) < 0) {
+        ScopedLatency latency(Probe::ProducerWait);
+        sem_wait(&space_);
     }
-    sem_post(&empty_);
+
+    push_waiters_.fetch_sub(1);
+}
+
+template <class T>
+void ReadyRing<T>::wait_for_items() {
+    pop_waiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    size_t pos = head_.load(std::memory_order_relaxed);
+    size_t seq = buf_[pos % cap_].seq.load(std::memory_order_acquire);
+    if (static_cast<std::ptrdiff_t>(seq - (2 * pos + 1)) < 0) {
+        ScopedLatency latency(Probe::ConsumerWait);
+        sem_wait(&items_);
+    }
+
+    pop_waiters_.fetch_sub(1);
+}
+
+// One post per sleeper, but never more than the slots/items just made available
+template <class T>
+void ReadyRing<T>::wake_consumers(size_t n) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int waiters = pop_waiters_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n && static_cast<int>(i) < waiters; i++) sem_post(&items_);
+}
+
+template <class T>
+void ReadyRing<T>::wake_producers(size_t n) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int waiters = push_waiters_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n && static_cast<int>(i) < waiters; i++) sem_post(&space_);
+}
+
+template <class T>
+void ReadyRing<T>::push(const T& p) {
+    push_with([&](T& dst) { dst = p; });
+}
+
+template <class T>
+void ReadyRing<T>::push(T&& p) {
+    push_with([&](T& dst) { dst = std::move(p); });
+}
+
+template <class T>
+bool ReadyRing<T>::try_push(T&& p) {
+    size_t pos;
+    Slot* s = claim_push(pos);
+    if (!s) return false;
+    s->value = std::move(p);
+    s->seq.store(2 * pos + 1, std::memory_order_release);
+    wake_consumers();
+    return true;
+}
+
+template <class T>
+void ReadyRing<T>::push_bulk(std::vector<T>& items) {
+    size_t pushed = 0;
+    for (auto& p : items) {
+        size_t pos;
+        Slot* s;
+        while ((s = claim_push(pos)) == nullptr) {
+            // about to sleep: let consumers drain what we already published
+            wake_consumers(pushed);
+            pushed = 0;
+            wait_for_space();
+        }
+        s->value = std::move(p);
+        s->seq.store(2 * pos + 1, std::memory_order_release);
+        pushed++;
+    }
+    wake_consumers(pushed);
+    items.clear();
+}
+
+template <class T>
+T ReadyRing<T>::pop() {
+    size_t pos;
+    Slot* s;
+    while ((s = claim_pop(pos)) == nullptr) wait_for_items();
+
+    T item = std::move(s->value);
+    s->seq.store(2 * (pos + cap_), std::memory_order_release);
+    wake_producers();
     return item;
 }
 
-size_t ReadyBuffer::size() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return count_;
+template <class T>
+bool ReadyRing<T>::try_pop(T& out) {
+    size_t pos;
+    Slot* s = claim_pop(pos);
+    if (!s) return false;
+    out = std::move(s->value);
+    s->seq.store(2 * (pos + cap_), std::memory_order_release);
+    wake_producers();
+    return true;
+}
+
+template <class T>
+size_t ReadyRing<T>::pop_bulk(std::vector<T>& out, size_t max_items) {
+    if (max_items == 0) return 0;
+
+    out.push_back(pop());
+    size_t taken = 1;
+    while (taken < max_items) {
+        size_t pos;
+        Slot* s = claim_pop(pos);
+        if (!s) break;
+        out.push_back(std::move(s->value));
+        s->seq.store(2 * (pos + cap_), std::memory_order_release);
+        taken++;
+    }
+    // pop() already woke one producer for the first item
+    if (taken > 1) wake_producers(taken - 1);
+    return taken;
+}
+
+template <class T>
+size_t ReadyRing<T>::size() const {
+    // snapshot only: may be stale by the time the caller looks at it
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? std::min(tail - head, cap_) : 0;
 }
 
+template class ReadyRing<Process>;
+template class ReadyRing<ProcessHandle>;
@@ -1,31 +1,96 @@
 #pragma once
+#include <atomic>
+#include <memory>
 #include <vector>
-#include <mutex>
 #include <semaphore.h>
 #include "process.hpp"
+#include "process_pool.hpp"
 
-// Bounded buffer for Process objects (ready queue)
-class ReadyBuffer {
+// Bounded buffer for the ready queue
+//
+// Lock-free MPMC ring: every slot carries a sequence number telling
+// producers/consumers whether it is free or filled for the current lap.
+// Threads only sleep (on a semaphore) when the ring is really full/empty,
+// so there is still no busy waiting.
+//
+// Instantiated for Process (whole records) and ProcessHandle (indices into
+// a ProcessPool, what the simulator pipeline passes around).
+template <class T>
+class ReadyRing {
 public:
-    explicit ReadyBuffer(size_t capacity);
-    ~ReadyBuffer();
+    explicit ReadyRing(size_t capacity);
+    ~ReadyRing();
 
-    // Producer puts a process into buffer
-    void push(const Process& p);
+    ReadyRing(const ReadyRing&) = delete;
+    ReadyRing& operator=(const ReadyRing&) = delete;
 
-    // Consumer takes a process from buffer
-    Process pop();
+    // Producer puts an item into buffer
+    void push(const T& p);
+    void push(T&& p);
+
+    // Build the item directly inside a free slot
+    template <class... Args>
+    void emplace(Args&&... args) {
+        push_with([&](T& dst) { dst = T(std::forward<Args>(args)...); });
+    }
+
+    // Push all items (moved out of the vector); consumers are woken once per batch
+    void push_bulk(std::vector<T>& items);
+
+    // Consumer takes an item from buffer
+    T pop();
+
+    // Blocks until at least one item is available, then takes up to max_items
+    // without blocking again. Returns the number appended to out.
+    size_t pop_bulk(std::vector<T>& out, size_t max_items);
+
+    // Non-blocking variants
+    bool try_push(T&& p);
+    bool try_pop(T& out);
 
     size_t capacity() const { return cap_; }
-     size_t size();
+    size_t size() const;
+
 private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
     size_t cap_;
-    std::vector<Process> buf_;
-    size_t head_{0}; // pop index
-    size_t tail_{0}; // push index
-    size_t count_{0}; 
-    sem_t empty_;    // counts empty slots
-    sem_t full_;     // counts filled slots
-    std::mutex mtx_; // protects buffer indices and data
+    std::unique_ptr<Slot[]> buf_;
+
+    alignas(64) std::atomic<size_t> tail_{0}; // push position
+    alignas(64) std::atomic<size_t> head_{0}; // pop position
+
+    // Slow path only: sleepers register here before waiting
+    alignas(64) std::atomic<int> push_waiters_{0};
+    std::atomic<int> pop_waiters_{0};
+    sem_t space_;    // posted when a slot frees up and a producer is asleep
+    sem_t items_;    // posted when an item lands and a consumer is asleep
+
+    // Reserve a slot; nullptr when the ring is full / empty
+    Slot* claim_push(size_t& pos);
+    Slot* claim_pop(size_t& pos);
+
+    void wait_for_space();
+    void wait_for_items();
+    void wake_consumers(size_t n = 1);
+    void wake_producers(size_t n = 1);
+
+    template <class Fill>
+    void push_with(Fill&& fill) {
+        size_t pos;
+        Slot* s;
+        while ((s = claim_push(pos)) == nullptr) wait_for_space();
+        fill(s->value);
+        s->seq.store(2 * pos + 1, std::memory_order_release);
+        wake_consumers();
+    }
 };
 
+extern template class ReadyRing<Process>;
+extern template class ReadyRing<ProcessHandle>;
+
+using ReadyBuffer = ReadyRing<Process>;
+using HandleBuffer = ReadyRing<ProcessHandle>;
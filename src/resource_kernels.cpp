@@ -0,0 +1,229 @@
+#include "resource_kernels.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MOS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ---------------- scalar ----------------
+
+bool leq_scalar(const int* a, const int* b, size_t m) {
+    for (size_t i = 0; i < m; i++) if (a[i] > b[i]) return false;
+    return true;
+}
+
+void add_scalar(int* dst, const int* src, size_t m) {
+    for (size_t i = 0; i < m; i++) dst[i] += src[i];
+}
+
+void sub_scalar(int* dst, const int* src, size_t m) {
+    for (size_t i = 0; i < m; i++) dst[i] -= src[i];
+}
+
+// ---------------- fixed width (m ignored, fully unrolled) ----------------
+//
+// Expanded with fold expressions so the unrolling does not depend on the
+// optimiser: whole 4-lane blocks use SSE2 where the target has it (always
+// on x86-64), the remaining lanes are scalar.
+
+#ifdef __SSE2__
+constexpr size_t kFixedLanes = 4;
+inline __m128i load4(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void store4(int* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+#else
+constexpr size_t kFixedLanes = 0;
+#endif
+
+constexpr size_t fixed_blocks(size_t m) { return kFixedLanes ? m / kFixedLanes : 0; }
+
+template <size_t... V, size_t... S>
+bool leq_unrolled(const int* a, const int* b, std::index_sequence<V...>, std::index_sequence<S...>) {
+    constexpr size_t base = sizeof...(V) * kFixedLanes;
+    int gt = 0;
+#ifdef __SSE2__
+    gt = (_mm_movemask_epi8(_mm_cmpgt_epi32(load4(a + V * 4), load4(b + V * 4))) | ... | 0);
+#endif
+    return gt == 0 && (true && ... && (a[base + S] <= b[base + S]));
+}
+
+template <size_t... V, size_t... S>
+void add_unrolled(int* dst, const int* src, std::index_sequence<V...>, std::index_sequence<S...>) {
+    constexpr size_t base = sizeof...(V) * kFixedLanes;
+#ifdef __SSE2__
+    (store4(dst + V * 4, _mm_add_epi32(load4(dst + V * 4), load4(src + V * 4))), ...);
+#endif
+    ((dst[base + S] += src[base + S]), ...);
+}
+
+template <size_t... V, size_t... S>
+void sub_unrolled(int* dst, const int* src, std::index_sequence<V...>, std::index_sequence<S...>) {
+    constexpr size_t base = sizeof...(V) * kFixedLanes;
+#ifdef __SSE2__
+    (store4(dst + V * 4, _mm_sub_epi32(load4(dst + V * 4), load4(src + V * 4))), ...);
+#endif
+    ((dst[base + S] -= src[base + S]), ...);
+}
+
+template <size_t M>
+using FixedBlocks = std::make_index_sequence<fixed_blocks(M)>;
+template <size_t M>
+using FixedTail = std::make_index_sequence<M - fixed_blocks(M) * kFixedLanes>;
+
+template <size_t M>
+bool leq_fixed(const int* a, const int* b, size_t) {
+    return leq_unrolled(a, b, FixedBlocks<M>{}, FixedTail<M>{});
+}
+
+template <size_t M>
+void add_fixed(int* dst, const int* src, size_t) {
+    add_unrolled(dst, src, FixedBlocks<M>{}, FixedTail<M>{});
+}
+
+template <size_t M>
+void sub_fixed(int* dst, const int* src, size_t) {
+    sub_unrolled(dst, src, FixedBlocks<M>{}, FixedTail<M>{});
+}
+
+template <size_t M>
+constexpr ResourceKernels fixed_kernels() {
+    return {&leq_fixed<M>, &add_fixed<M>, &sub_fixed<M>, KernelIsa::Scalar, M};
+}
+
+constexpr ResourceKernels kFixed[kMaxFixedWidth + 1] = {
+    {&leq_scalar, &add_scalar, &sub_scalar, KernelIsa::Scalar, 0},
+    fixed_kernels<1>(), fixed_kernels<2>(), fixed_kernels<3>(), fixed_kernels<4>(),
+    fixed_kernels<5>(), fixed_kernels<6>(), fixed_kernels<7>(), fixed_kernels<8>(),
+};
+
+#ifdef MOS_X86_KERNELS
+
+// ---------------- SSE2 (baseline on x86-64) ----------------
+
+__attribute__((target("sse2")))
+bool leq_sse2(const int* a, const int* b, size_t m) {
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi32(va, vb))) return false;
+    }
+    for (; i < m; i++) if (a[i] > b[i]) return false;
+    return true;
+}
+
+__attribute__((target("sse2")))
+void add_sse2(int* dst, const int* src, size_t m) {
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(d, s));
+    }
+    for (; i < m; i++) dst[i] += src[i];
+}
+
+__attribute__((target("sse2")))
+void sub_sse2(int* dst, const int* src, size_t m) {
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(d, s));
+    }
+    for (; i < m; i++) dst[i] -= src[i];
+}
+
+// ---------------- AVX2 ----------------
+
+__attribute__((target("avx2")))
+bool leq_avx2(const int* a, const int* b, size_t m) {
+    size_t i = 0;
+    for (; i + 8 <= m; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(va, vb))) return false;
+    }
+    for (; i < m; i++) if (a[i] > b[i]) return false;
+    return true;
+}
+
+__attribute__((target("avx2")))
+void add_avx2(int* dst, const int* src, size_t m) {
+    size_t i = 0;
+    for (; i + 8 <= m; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi32(d, s));
+    }
+    for (; i < m; i++) dst[i] += src[i];
+}
+
+__attribute__((target("avx2")))
+void sub_avx2(int* dst, const int* src, size_t m) {
+    size_t i = 0;
+    for (; i + 8 <= m; i += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(d, s));
+    }
+    for (; i < m; i++) dst[i] -= src[i];
+}
+
+#endif // MOS_X86_KERNELS
+
+KernelIsa cpu_isa() {
+#ifdef MOS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return KernelIsa::Avx2;
+    if (__builtin_cpu_supports("sse2")) return KernelIsa::Sse2;
+#endif
+    return KernelIsa::Scalar;
+}
+
+} // namespace
+
+const char* isa_name(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::Scalar: return "scalar";
+    case KernelIsa::Sse2:   return "sse2";
+    case KernelIsa::Avx2:   return "avx2";
+    }
+    return "?";
+}
+
+KernelIsa detected_isa() {
+    static const KernelIsa isa = [] {
+        KernelIsa best = cpu_isa();
+        if (const char* env = std::getenv("MOS_KERNELS")) {
+            for (KernelIsa cap : {KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2})
+                if (std::strcmp(env, isa_name(cap)) == 0 && cap < best) best = cap;
+        }
+        return best;
+    }();
+    return isa;
+}
+
+ResourceKernels kernels_for(KernelIsa isa) {
+#ifdef MOS_X86_KERNELS
+    if (isa > cpu_isa()) isa = KernelIsa::Scalar;
+    switch (isa) {
+    case KernelIsa::Avx2: return {&leq_avx2, &add_avx2, &sub_avx2, KernelIsa::Avx2, 0};
+    case KernelIsa::Sse2: return {&leq_sse2, &add_sse2, &sub_sse2, KernelIsa::Sse2, 0};
+    case KernelIsa::Scalar: break;
+    }
+#else
+    (void)isa;
+#endif
+    return kFixed[0];
+}
+
+ResourceKernels select_kernels(size_t m) {
+    if (m >= 1 && m <= kMaxFixedWidth) return kFixed[m];
+    return kernels_for(detected_isa());
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+// In-place kernels over m-wide rows of resource counts, used by Bankers in
+// the safety check and on every grant/rollback.
+//
+// select_kernels(m) picks, once per Bankers instance:
+//   - a fully unrolled fixed-width version for m <= kMaxFixedWidth
+//   - otherwise the widest vector ISA the CPU supports (AVX2, SSE2), with a
+//     scalar loop on other targets
+// Every variant computes exactly what the scalar loop does, provided dst and
+// src are the same row or do not overlap.
+enum class KernelIsa { Scalar, Sse2, Avx2 };
+
+struct ResourceKernels {
+    // a[i] <= b[i] for every i
+    bool (*leq)(const int* a, const int* b, size_t m);
+    // dst[i] += src[i]
+    void (*add)(int* dst, const int* src, size_t m);
+    // dst[i] -= src[i]
+    void (*sub)(int* dst, const int* src, size_t m);
+    KernelIsa isa;
+    size_t fixed_width;   // 0 => generic width
+};
+
+constexpr size_t kMaxFixedWidth = 8;
+
+// Widest ISA usable on this CPU. MOS_KERNELS=scalar|sse2|avx2 in the
+// environment lowers it (e.g. to compare variants).
+KernelIsa detected_isa();
+const char* isa_name(KernelIsa isa);
+
+ResourceKernels select_kernels(size_t m);
+// Generic-width kernels of one ISA (falls back to Scalar if unsupported)
+ResourceKernels kernels_for(KernelIsa isa);
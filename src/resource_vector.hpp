@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Resource claim vector (R1..Rm). Up to kInline values live inside the
+// object, so copying or moving a Process with a typical claim never touches
+// the allocator; wider claims spill to a single heap array.
+class ResourceVector {
+public:
+    static constexpr size_t kInline = 8;
+
+    using value_type = int;
+    using iterator = int*;
+    using const_iterator = const int*;
+
+    ResourceVector() = default;
+    ResourceVector(size_t n, int value) { resize(n, value); }
+    ResourceVector(std::initializer_list<int> values) { assign(values.begin(), values.end()); }
+    // Implicit so claims built as std::vector<int> keep working
+    ResourceVector(const std::vector<int>& values) { assign(values.begin(), values.end()); }
+
+    ResourceVector(const ResourceVector& o) { assign(o.begin(), o.end()); }
+    ResourceVector(ResourceVector&& o) noexcept { take(o); }
+    ResourceVector& operator=(const ResourceVector& o) {
+        if (this != &o) assign(o.begin(), o.end());
+        return *this;
+    }
+    ResourceVector& operator=(ResourceVector&& o) noexcept {
+        if (this != &o) {
+            heap_.reset();
+            take(o);
+        }
+        return *this;
+    }
+
+    template <class It>
+    void assign(It first, It last) {
+        size_ = 0;
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        std::copy(first, last, data());
+        size_ = static_cast<uint32_t>(std::distance(first, last));
+    }
+
+    void push_back(int v) {
+        if (size_ == cap_) reserve(2 * static_cast<size_t>(cap_));
+        data()[size_++] = v;
+    }
+
+    void resize(size_t n, int value = 0) {
+        reserve(n);
+        if (n > size_) std::fill(data() + size_, data() + n, value);
+        size_ = static_cast<uint32_t>(n);
+    }
+
+    // Keeps the contents; spills to the heap once n exceeds kInline
+    void reserve(size_t n) {
+        if (n <= cap_) return;
+        std::unique_ptr<int[]> grown(new int[n]);
+        std::copy(begin(), end(), grown.get());
+        heap_ = std::move(grown);
+        cap_ = static_cast<uint32_t>(n);
+    }
+
+    void clear() { size_ = 0; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool spilled() const { return heap_ != nullptr; }
+
+    int* data() { return heap_ ? heap_.get() : inline_; }
+    const int* data() const { return heap_ ? heap_.get() : inline_; }
+    int* begin() { return data(); }
+    int* end() { return data() + size_; }
+    const int* begin() const { return data(); }
+    const int* end() const { return data() + size_; }
+
+    int& operator[](size_t i) { return data()[i]; }
+    int operator[](size_t i) const { return data()[i]; }
+
+    std::vector<int> to_vector() const { return std::vector<int>(begin(), end()); }
+
+    friend bool operator==(const ResourceVector& a, const ResourceVector& b) {
+        return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const ResourceVector& a, const ResourceVector& b) { return !(a == b); }
+
+private:
+    std::unique_ptr<int[]> heap_;   // null while the values fit inline_
+    uint32_t size_{0};
+    uint32_t cap_{kInline};
+    int inline_[kInline];
+
+    // Steals a spilled array, copies an inline one; o is left empty
+    void take(ResourceVector& o) {
+        size_ = o.size_;
+        if (o.heap_) {
+            heap_ = std::move(o.heap_);
+            cap_ = o.cap_;
+        } else {
+            cap_ = kInline;
+            std::copy(o.inline_, o.inline_ + o.size_, inline_);
+        }
+        o.size_ = 0;
+        o.cap_ = kInline;
+    }
+};
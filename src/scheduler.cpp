@@ -1,45 +1,132 @@
 #include "scheduler.hpp"
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <queue>
+#include <set>
+#include <stdexcept>
+#include "gantt.hpp"
+#include "metrics.hpp"
+#include "policies.hpp"
 
 ScheduleResult Scheduler::run(std::vector<Process> procs, int quantum) {
-    if (procs.size() <= 5) return priority_nonpreemptive(std::move(procs));
-    return round_robin(std::move(procs), quantum);
+    return run(std::move(procs), SchedPolicy::Auto, quantum);
 }
 
+ScheduleResult Scheduler::run(std::vector<Process> procs, SchedPolicy policy, int quantum, StatsDetail detail) {
+    ScopedLatency latency(Probe::Schedule);
+    return dispatch(std::move(procs), policy, quantum, nullptr, detail);
+}
+
+ScheduleResult Scheduler::run(std::vector<Process> procs, SchedPolicy policy, int quantum, GanttSink& sink,
+                              StatsDetail detail) {
+    ScopedLatency latency(Probe::Schedule);
+    ScheduleResult out = dispatch(std::move(procs), policy, quantum, &sink, detail);
+    sink.finish();
+    return out;
+}
+
+ScheduleResult Scheduler::dispatch(std::vector<Process> procs, SchedPolicy policy, int quantum, GanttSink* sink,
+                                   StatsDetail detail) {
+    switch (policy) {
+    case SchedPolicy::Priority:           return priority_nonpreemptive(std::move(procs), sink, detail);
+    case SchedPolicy::PriorityPreemptive: return priority_preemptive(std::move(procs), sink, detail);
+    case SchedPolicy::RoundRobin:         return round_robin(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::RoundRobinRounds:   return round_robin_rounds(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::Srtf:               return simulate<SrtfPolicy>(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::Mlfq:               return simulate<MlfqPolicy>(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::Cfs:                return simulate<CfsPolicy>(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::Edf:                return simulate<EdfPolicy>(std::move(procs), quantum, sink, detail);
+    case SchedPolicy::Auto:               break;
+    }
+    if (procs.size() <= 5) return priority_nonpreemptive(std::move(procs), sink, detail);
+    return round_robin(std::move(procs), quantum, sink, detail);
+}
+
+const char* Scheduler::policy_name(SchedPolicy policy) {
+    switch (policy) {
+    case SchedPolicy::Auto:               return "auto";
+    case SchedPolicy::Priority:           return "priority";
+    case SchedPolicy::PriorityPreemptive: return "priority-preemptive";
+    case SchedPolicy::RoundRobin:         return "rr";
+    case SchedPolicy::RoundRobinRounds:   return "rr-rounds";
+    case SchedPolicy::Srtf:               return "srtf";
+    case SchedPolicy::Mlfq:               return "mlfq";
+    case SchedPolicy::Cfs:                return "cfs";
+    case SchedPolicy::Edf:                return "edf";
+    }
+    return "?";
+}
+
+SchedPolicy Scheduler::parse_policy(const std::string& name) {
+    for (SchedPolicy p : {SchedPolicy::Auto, SchedPolicy::Priority, SchedPolicy::PriorityPreemptive,
+                          SchedPolicy::RoundRobin, SchedPolicy::RoundRobinRounds, SchedPolicy::Srtf,
+                          SchedPolicy::Mlfq, SchedPolicy::Cfs, SchedPolicy::Edf})
+        if (name == policy_name(p)) return p;
+    throw std::invalid_argument("unknown policy " + name);
+}
+
+bool Scheduler::uses_quantum(SchedPolicy policy) {
+    return policy != SchedPolicy::Priority && policy != SchedPolicy::PriorityPreemptive &&
+           policy != SchedPolicy::Srtf && policy != SchedPolicy::Edf;
+}
+
+namespace {
+
+// Indices of procs ordered by (arrival, priority); ties keep input order
+std::vector<size_t> arrival_order(const std::vector<Process>& procs) {
+    std::vector<size_t> order(procs.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (procs[a].arrival_time != procs[b].arrival_time)
+            return procs[a].arrival_time < procs[b].arrival_time;
+        return procs[a].priority < procs[b].priority; // lower = higher priority
+    });
+    return order;
+}
+
+// Min-heap on (priority, arrival, position in arrival order). The last key
+// reproduces "first match in the ready list" of a linear scan.
+struct PriorityCmp {
+    const std::vector<Process>* procs;
+    const std::vector<size_t>* rank;
+    bool operator()(size_t a, size_t b) const {
+        const Process& x = (*procs)[a];
+        const Process& y = (*procs)[b];
+        if (x.priority != y.priority) return x.priority > y.priority;
+        if (x.arrival_time != y.arrival_time) return x.arrival_time > y.arrival_time;
+        return (*rank)[a] > (*rank)[b];
+    }
+};
+
+} // namespace
+
 // Assumption: Priority scheduling = NON-preemptive (common in labs).
-// If your teacher wants preemptive priority, we can modify later.
-ScheduleResult Scheduler::priority_nonpreemptive(std::vector<Process> procs) {
+// See priority_preemptive for the preemptive variant.
+ScheduleResult Scheduler::priority_nonpreemptive(std::vector<Process> procs, GanttSink* sink, StatsDetail detail) {
     ScheduleResult out;
 
-    std::sort(procs.begin(), procs.end(), [](const Process& a, const Process& b){
-        if (a.arrival_time != b.arrival_time) return a.arrival_time < b.arrival_time;
-        return a.priority < b.priority; // lower = higher priority
-    });
+    std::vector<size_t> order = arrival_order(procs);
+    std::vector<size_t> rank(procs.size());
+    for (size_t k = 0; k < order.size(); k++) rank[order[k]] = k;
 
+    std::priority_queue<size_t, std::vector<size_t>, PriorityCmp> ready(PriorityCmp{&procs, &rank});
     int t = 0;
-    std::vector<Process> done;
-    std::vector<Process> ready;
     size_t i = 0;
 
-    while (i < procs.size() || !ready.empty()) {
-        while (i < procs.size() && procs[i].arrival_time <= t) {
-            ready.push_back(procs[i]);
+    while (i < order.size() || !ready.empty()) {
+        while (i < order.size() && procs[order[i]].arrival_time <= t) {
+            ready.push(order[i]);
             i++;
         }
 
         if (ready.empty()) {
-            t = procs[i].arrival_time;
+            t = procs[order[i]].arrival_time;
             continue;
         }
 
-        auto it = std::min_element(ready.begin(), ready.end(), [](const Process& x, const Process& y){
-            if (x.priority != y.priority) return x.priority < y.priority;
-            return x.arrival_time < y.arrival_time;
-        });
-
-        Process p = *it;
-        ready.erase(it);
+        Process& p = procs[ready.top()];
+        ready.pop();
 
         if (p.start_time == -1) p.start_time = t;
         int start = t;
@@ -47,16 +134,71 @@ ScheduleResult Scheduler::priority_nonpreemptive(std::vector<Process> procs) {
         p.remaining_time = 0;
         p.finish_time = t;
 
-        out.gantt.push_back({p.pid, start, t});
-        done.push_back(p);
+        if (sink) sink->add(p.pid, start, t);
+        else out.gantt.push_back({p.pid, start, t});
+    }
+
+    out.finish_time = t;
+    compute_stats(procs, out, detail);
+    return out;
+}
+
+// Same arrival-event loop, but the running process only keeps the CPU until
+// the next arrival; if a higher-priority process arrived it is preempted.
+ScheduleResult Scheduler::priority_preemptive(std::vector<Process> procs, GanttSink* sink, StatsDetail detail) {
+    ScheduleResult out;
+
+    std::vector<size_t> order = arrival_order(procs);
+    std::vector<size_t> rank(procs.size());
+    for (size_t k = 0; k < order.size(); k++) rank[order[k]] = k;
+
+    std::priority_queue<size_t, std::vector<size_t>, PriorityCmp> ready(PriorityCmp{&procs, &rank});
+    int t = 0;
+    size_t i = 0;
+
+    while (i < order.size() || !ready.empty()) {
+        while (i < order.size() && procs[order[i]].arrival_time <= t) {
+            ready.push(order[i]);
+            i++;
+        }
+
+        if (ready.empty()) {
+            t = procs[order[i]].arrival_time;
+            continue;
+        }
+
+        size_t idx = ready.top();
+        Process& p = procs[idx];
+        if (p.start_time == -1) p.start_time = t;
+
+        // Run until completion or the next arrival, whichever comes first
+        int run = p.remaining_time;
+        if (i < order.size()) run = std::min(run, procs[order[i]].arrival_time - t);
+
+        int start = t;
+        t += run;
+        p.remaining_time -= run;
+
+        // Extend the previous slice when the same process keeps the CPU
+        if (sink)
+            sink->add(p.pid, start, t);
+        else if (!out.gantt.empty() && out.gantt.back().pid == p.pid && out.gantt.back().end == start)
+            out.gantt.back().end = t;
+        else
+            out.gantt.push_back({p.pid, start, t});
+
+        if (p.remaining_time == 0) {
+            ready.pop();
+            p.finish_time = t;
+        }
     }
 
     out.finish_time = t;
-    compute_stats(done, out);
+    compute_stats(procs, out, detail);
     return out;
 }
 
-ScheduleResult Scheduler::round_robin(std::vector<Process> procs, int quantum) {
+ScheduleResult Scheduler::round_robin(std::vector<Process> procs, int quantum, GanttSink* sink, StatsDetail detail) {
     ScheduleResult out;
 
     std::sort(procs.begin(), procs.end(), [](const Process& a, const Process& b){
@@ -87,7 +229,8 @@ ScheduleResult Scheduler::round_robin(std::vector<Process> procs, int quantum) {
         t += run;
         p.remaining_time -= run;
 
-        out.gantt.push_back({p.pid, start, t});
+        if (sink) sink->add(p.pid, start, t);
+        else out.gantt.push_back({p.pid, start, t});
 
         while (i < procs.size() && procs[i].arrival_time <= t) {
             q.push(procs[i]);
@@ -103,26 +246,373 @@ ScheduleResult Scheduler::round_robin(std::vector<Process> procs, int quantum) {
     }
 
     out.finish_time = t;
-    compute_stats(done, out);
+    compute_stats(done, out, detail);
     return out;
 }
 
-void Scheduler::compute_stats(std::vector<Process>& done, ScheduleResult& out) {
-    double sum_w = 0, sum_t = 0;
+namespace {
+
+// Ring of queued processes for round_robin_rounds: a treap in ring order,
+// indexed by queued (alive) rank, with the earliest event lap of each
+// subtree. Finished processes stay as dead nodes so that the final in-order
+// walk yields every process's ring position. Node i is process i.
+class RoundTree {
+public:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr long long kNever = std::numeric_limits<long long>::max();
+
+    explicit RoundTree(size_t n) : nodes_(n) {
+        uint64_t x = 0x9E3779B97F4A7C15ull;
+        for (auto& node : nodes_) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            node.prio = static_cast<uint32_t>(x >> 32);
+        }
+    }
 
-    for (auto& p : done) {
-        int tat = p.finish_time - p.arrival_time;
-        int wt  = tat - p.burst_time;
+    size_t size() const { return alive(root_); }
 
-        out.turnaround[p.pid] = tat;
-        out.waiting[p.pid] = wt;
+    // Queues node i at rank r with its next event in lap `key`
+    void insert(uint32_t i, size_t r, long long key) {
+        nodes_[i].key = key;
+        nodes_[i].queued = true;
+        pull(i);
+        auto [a, b] = split(root_, r);
+        root_ = merge(merge(a, i), b);
+    }
 
-        sum_w += wt;
-        sum_t += tat;
+    // Earliest event: smallest lap, then lowest rank
+    std::pair<uint32_t, size_t> next_event() const {
+        uint32_t t = root_;
+        size_t rank = 0;
+        while (true) {
+            const Node& n = nodes_[t];
+            if (n.left != kNil && nodes_[n.left].min_key == n.min_key) {
+                t = n.left;
+                continue;
+            }
+            rank += alive(n.left);
+            if (n.queued && n.key == n.min_key) return {t, rank};
+            rank += n.queued;
+            t = n.right;
+        }
     }
+    long long key(uint32_t i) const { return nodes_[i].key; }
 
-    if (!done.empty()) {
-        out.avg_waiting = sum_w / done.size();
-        out.avg_turnaround = sum_t / done.size();
+    // Node at rank r
+    uint32_t at(size_t r) const {
+        uint32_t t = root_;
+        while (true) {
+            const Node& n = nodes_[t];
+            size_t ls = alive(n.left);
+            if (r < ls) {
+                t = n.left;
+            } else if (n.queued && r == ls) {
+                return t;
+            } else {
+                r -= ls + n.queued;
+                t = n.right;
+            }
+        }
     }
+
+    // Changes the event lap of the node at rank r, or dequeues it
+    void set_key(size_t r, long long key) { update(root_, r, key, true); }
+    void remove(size_t r) { update(root_, r, kNever, false); }
+
+    // Every node ever inserted, in ring order
+    template <class Fn>
+    void for_each(Fn&& fn) const {
+        std::vector<uint32_t> stack;
+        for (uint32_t t = root_; t != kNil || !stack.empty();) {
+            if (t != kNil) {
+                stack.push_back(t);
+                t = nodes_[t].left;
+                continue;
+            }
+            t = stack.back();
+            stack.pop_back();
+            fn(t);
+            t = nodes_[t].right;
+        }
+    }
+
+private:
+    struct Node {
+        uint32_t left{kNil}, right{kNil};
+        uint32_t prio{0};
+        bool queued{false};
+        size_t size{0};                // queued nodes in the subtree
+        long long key{kNever};
+        long long min_key{kNever};
+    };
+    std::vector<Node> nodes_;
+    uint32_t root_{kNil};
+
+    size_t alive(uint32_t t) const { return t == kNil ? 0 : nodes_[t].size; }
+    long long min_key(uint32_t t) const { return t == kNil ? kNever : nodes_[t].min_key; }
+
+    void pull(uint32_t t) {
+        Node& n = nodes_[t];
+        n.size = alive(n.left) + n.queued + alive(n.right);
+        n.min_key = std::min({min_key(n.left), n.queued ? n.key : kNever, min_key(n.right)});
+    }
+
+    // First r queued nodes (and any dead ones among them) go left
+    std::pair<uint32_t, uint32_t> split(uint32_t t, size_t r) {
+        if (t == kNil) return {kNil, kNil};
+        Node& n = nodes_[t];
+        size_t ls = alive(n.left);
+        if (r <= ls) {
+            auto [a, b] = split(n.left, r);
+            nodes_[t].left = b;
+            pull(t);
+            return {a, t};
+        }
+        auto [a, b] = split(n.right, r - ls - n.queued);
+        nodes_[t].right = a;
+        pull(t);
+        return {t, b};
+    }
+
+    uint32_t merge(uint32_t a, uint32_t b) {
+        if (a == kNil) return b;
+        if (b == kNil) return a;
+        if (nodes_[a].prio > nodes_[b].prio) {
+            nodes_[a].right = merge(nodes_[a].right, b);
+            pull(a);
+            return a;
+        }
+        nodes_[b].left = merge(a, nodes_[b].left);
+        pull(b);
+        return b;
+    }
+
+    void update(uint32_t t, size_t r, long long key, bool queued) {
+        Node& n = nodes_[t];
+        size_t ls = alive(n.left);
+        if (r < ls) {
+            update(n.left, r, key, queued);
+        } else if (n.queued && r == ls) {
+            n.key = key;
+            n.queued = queued;
+        } else {
+            update(n.right, r - ls - n.queued, key, queued);
+        }
+        pull(t);
+    }
+};
+
+} // namespace
+
+// Round Robin without simulating every quantum. Round robin never reorders
+// its queue: an arrival joins at the tail, a preempted process goes back
+// behind it. So the queue is a ring in which every process keeps its place,
+// and the dispatcher sweeps it lap after lap. A process with remaining time
+// r that is first served in lap f gets a full quantum in laps f .. f+c-2 and
+// r - (c-1)*quantum in lap f+c-1, where c = ceil(r / quantum): both laps are
+// known when it is queued and never change. Only two events per process
+// matter, its first slice (start time) and its last (finish time); every
+// slice between two events is a full quantum. Events are taken in (lap,
+// ring rank) order from a treap over the ring, so the time up to the next
+// event is one multiplication, and an arrival is placed after
+// ceil((arrival - t) / quantum) further slices. The queue semantics are
+// exactly those of round_robin, so the schedule and all stats match it.
+//
+// Cost: O(n log n) expected, whatever the bursts and the quantum. The Gantt
+// is one GanttRound per stretch between events (O(n) entries) over the ring
+// of process places, not a list of pids per round.
+ScheduleResult Scheduler::round_robin_rounds(std::vector<Process> procs, int quantum, GanttSink* sink,
+                                             StatsDetail detail) {
+    if (quantum <= 0) throw std::invalid_argument("quantum must be > 0");
+    ScheduleResult out;
+    const long long q = quantum;
+
+    // Same comparator and algorithm as round_robin => same order for ties
+    std::vector<size_t> order(procs.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+        return procs[a].arrival_time < procs[b].arrival_time;
+    });
+
+    RoundTree ring(procs.size());
+    std::vector<long long> last_lap(procs.size());   // lap of the final slice
+    std::vector<int> last_run(procs.size());         // length of the final slice
+    std::vector<size_t> enter(procs.size()), leave(procs.size());
+    long long t = 0;
+    long long lap = 0;      // current lap
+    size_t at = 0;          // rank of the next process to serve in it
+    size_t i = 0;           // next arrival
+    bool ring_changed = true;
+
+    // Slices from the pointer, extending the previous entry when it continues
+    auto record = [&](long long start, long long slices, long long slice, uint32_t first) {
+        if (!ring_changed && !out.rounds.empty()) {
+            GanttRound& last = out.rounds.back();
+            if (last.slice == slice && last.start + last.slices * last.slice == start) {
+                last.slices += slices;
+                return;
+            }
+        }
+        out.rounds.push_back({start, slices, static_cast<int>(slice), first});
+        ring_changed = false;
+    };
+
+    // Moves the pointer past `slices` slices of a ring of k processes
+    auto advance = [&](long long slices) {
+        long long k = static_cast<long long>(ring.size());
+        long long pos = static_cast<long long>(at) + slices;
+        lap += pos / k;
+        at = static_cast<size_t>(pos % k);
+    };
+
+    // Queues process idx at rank r. Behind the pointer it is first served
+    // in the next lap, otherwise (the pointer at rank 0) in this one.
+    auto queue = [&](size_t idx, size_t r, bool behind) {
+        Process& p = procs[idx];
+        long long first_lap = behind ? lap + 1 : lap;
+        long long c = std::max(1LL, (p.remaining_time + q - 1) / q);
+        last_lap[idx] = first_lap + c - 1;
+        last_run[idx] = static_cast<int>(p.remaining_time - (c - 1) * q);
+        bool start_event = p.start_time == -1 && c > 1;
+        ring.insert(static_cast<uint32_t>(idx), r, start_event ? first_lap : last_lap[idx]);
+        enter[idx] = out.rounds.size();
+        ring_changed = true;
+    };
+
+    // Arrivals up to t join the tail: just behind the pointer, but ahead of
+    // `served` (the process whose slice just ended, if it is still queued)
+    auto admit_arrivals = [&](bool served) {
+        while (i < order.size() && procs[order[i]].arrival_time <= t) {
+            size_t idx = order[i++];
+            if (at > 0) {
+                queue(idx, served ? at - 1 : at, true);
+                at++;
+            } else {
+                queue(idx, served ? ring.size() - 1 : ring.size(), false);
+            }
+        }
+    };
+
+    while (i < order.size() || ring.size() > 0) {
+        if (ring.size() == 0) {
+            t = std::max<long long>(t, procs[order[i]].arrival_time);
+            at = 0;
+            admit_arrivals(false);
+            continue;
+        }
+
+        auto [e, rank] = ring.next_event();
+        long long k = static_cast<long long>(ring.size());
+        long long e_lap = ring.key(e);
+        long long before = e_lap == lap ? static_cast<long long>(rank) - static_cast<long long>(at)
+                                        : (k - static_cast<long long>(at)) + (e_lap - lap - 1) * k +
+                                              static_cast<long long>(rank);
+        long long e_start = t + before * q;
+
+        // An arrival during the full quanta before the event joins after the slice it falls in
+        if (i < order.size() && procs[order[i]].arrival_time <= e_start) {
+            long long slices = (procs[order[i]].arrival_time - t + q - 1) / q;
+            record(t, slices, q, ring.at(at));
+            advance(slices);
+            t += slices * q;
+            admit_arrivals(true);
+            continue;
+        }
+
+        if (before > 0) {
+            record(t, before, q, ring.at(at));
+            advance(before);
+            t = e_start;
+        }
+
+        Process& p = procs[e];
+        if (p.start_time == -1) p.start_time = static_cast<int>(t);
+        if (e_lap != last_lap[e]) {
+            // First slice, a full quantum; the next event is the last slice
+            record(t, 1, q, e);
+            ring.set_key(rank, last_lap[e]);
+            advance(1);
+            t += q;
+            admit_arrivals(true);
+            continue;
+        }
+
+        record(t, 1, last_run[e], e);
+        t += last_run[e];
+        p.remaining_time = 0;
+        p.finish_time = static_cast<int>(t);
+        leave[e] = out.rounds.size();
+        ring.remove(rank);
+        ring_changed = true;
+        if (at >= ring.size()) {
+            at = 0;
+            lap++;
+        }
+        admit_arrivals(false);
+    }
+
+    // Ring positions from the final in-order walk
+    std::vector<size_t> pos(procs.size());
+    ring.for_each([&](uint32_t idx) {
+        pos[idx] = out.ring.pids.size();
+        out.ring.pids.push_back(procs[idx].pid);
+        out.ring.enter.push_back(enter[idx]);
+        out.ring.leave.push_back(leave[idx]);
+    });
+    for (auto& g : out.rounds) g.first = pos[g.first];
+
+    if (sink) {
+        expand_rounds(out, [&](const GanttSlice& s) { sink->add(s.pid, s.start, s.end); });
+        out.rounds.clear();
+        out.ring = RoundRing();
+    }
+    out.finish_time = static_cast<int>(t);
+    compute_stats(procs, out, detail);
+    return out;
+}
+
+void Scheduler::expand_rounds(const ScheduleResult& r, const std::function<void(const GanttSlice&)>& fn) {
+    const RoundRing& ring = r.ring;
+    // Ring positions by the entry at which they join and leave the queue
+    std::vector<std::vector<size_t>> joins(r.rounds.size() + 1), leaves(r.rounds.size() + 1);
+    for (size_t k = 0; k < ring.pids.size(); k++) {
+        joins[ring.enter[k]].push_back(k);
+        leaves[ring.leave[k]].push_back(k);
+    }
+    std::set<size_t> queued;
+    for (size_t j = 0; j < r.rounds.size(); j++) {
+        for (size_t k : leaves[j]) queued.erase(k);
+        for (size_t k : joins[j]) queued.insert(k);
+        const GanttRound& g = r.rounds[j];
+        auto it = queued.find(g.first);
+        long long s = g.start;
+        for (long long n = 0; n < g.slices; n++, s += g.slice) {
+            fn({ring.pids[*it], static_cast<int>(s), static_cast<int>(s + g.slice)});
+            if (++it == queued.end()) it = queued.begin();
+        }
+    }
+}
+
+std::vector<GanttSlice> Scheduler::expand_rounds(const ScheduleResult& r) {
+    std::vector<GanttSlice> slices;
+    expand_rounds(r, [&](const GanttSlice& s) { slices.push_back(s); });
+    return slices;
+}
+
+void Scheduler::compute_stats(const std::vector<Process>& done, ScheduleResult& out, StatsDetail detail) {
+    if (detail == StatsDetail::PerProcess) out.per_process.reserve(done.size());
+    for (const auto& p : done) {
+        out.stats.add(p);
+        if (p.deadline >= 0 && p.finish_time > p.deadline) out.deadline_misses++;
+        if (detail == StatsDetail::PerProcess) {
+            int tat = p.finish_time - p.arrival_time;
+            int start = p.start_time >= 0 ? p.start_time : p.finish_time;
+            out.per_process.push_back({p.pid, tat - p.burst_time, tat, start - p.arrival_time});
+        }
+    }
+    std::sort(out.per_process.begin(), out.per_process.end(),
+              [](const ProcessTimes& a, const ProcessTimes& b) { return a.pid < b.pid; });
+
+    out.avg_waiting = out.stats.waiting.mean();
+    out.avg_turnaround = out.stats.turnaround.mean();
 }
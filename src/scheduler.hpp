@@ -1,7 +1,9 @@
 #pragma once
+#include <functional>
+#include <string>
 #include <vector>
-#include <unordered_map>
 #include "process.hpp"
+#include "stats.hpp"
 
 struct GanttSlice {
     int pid;
@@ -9,23 +11,92 @@ struct GanttSlice {
     int end;
 };
 
+// Compressed Gantt entry of RoundRobinRounds: `slices` consecutive slices of
+// `slice` time units from `start`, given to the queued processes in ring
+// order (RoundRing) from ring position `first`, wrapping around the ring
+struct GanttRound {
+    long long start;
+    long long slices;
+    int slice;
+    size_t first;
+};
+
+// Ready-queue order of RoundRobinRounds. Round robin never reorders the
+// processes it has queued (arrivals join at the tail), so each process keeps
+// one place in a ring of all of them: ring position k holds pids[k], queued
+// while rounds[enter[k] .. leave[k]) are played.
+struct RoundRing {
+    std::vector<int> pids;
+    std::vector<size_t> enter, leave;
+};
+
+class GanttSink;
+
 struct ScheduleResult {
     std::vector<GanttSlice> gantt;
-    std::unordered_map<int,int> waiting;
-    std::unordered_map<int,int> turnaround;
+    std::vector<GanttRound> rounds;   // filled instead of gantt by RoundRobinRounds
+    RoundRing ring;
+    ScheduleStats stats;                  // WT/TAT/response summaries, O(1) memory
+    std::vector<ProcessTimes> per_process; // sorted by pid; only with StatsDetail::PerProcess
     double avg_waiting{0};
     double avg_turnaround{0};
     int finish_time{0};
+    int deadline_misses{0};           // processes with a deadline that finished after it
+};
+
+enum class SchedPolicy {
+    Auto,                // <=5 Priority, >5 Round Robin
+    Priority,            // non-preemptive priority
+    PriorityPreemptive,  // preempts when a higher-priority process arrives
+    RoundRobin,
+    RoundRobinRounds,    // same schedule as RoundRobin, event-compressed
+    Srtf,                // shortest remaining time first
+    Mlfq,                // multi-level feedback queue with aging
+    Cfs,                 // weighted fair share on virtual runtime
+    Edf,                 // earliest deadline first
 };
 
+// How much of the per-process outcome a run keeps: the streaming summaries
+// always, one ProcessTimes per process only on request
+enum class StatsDetail { Summary, PerProcess };
+
 class Scheduler {
 public:
     // Rule: <=5 Priority, >5 Round Robin (q=4)
     static ScheduleResult run(std::vector<Process> procs, int quantum=4);
+    static ScheduleResult run(std::vector<Process> procs, SchedPolicy policy, int quantum=4,
+                              StatsDetail detail = StatsDetail::Summary);
+    // Streams merged slices into sink (then sink.finish()) instead of filling
+    // ScheduleResult::gantt/rounds; stats are filled as usual
+    static ScheduleResult run(std::vector<Process> procs, SchedPolicy policy, int quantum, GanttSink& sink,
+                              StatsDetail detail = StatsDetail::Summary);
 
-private:
-    static ScheduleResult priority_nonpreemptive(std::vector<Process> procs);
-    static ScheduleResult round_robin(std::vector<Process> procs, int quantum);
+    // CLI names: auto, priority, priority-preemptive, rr, rr-rounds, srtf, mlfq, cfs, edf
+    static const char* policy_name(SchedPolicy policy);
+    static SchedPolicy parse_policy(const std::string& name); // throws invalid_argument
+    static bool uses_quantum(SchedPolicy policy);
+
+    // Shared event loop specialised for one policy type (defined in policies.hpp)
+    template <class Policy>
+    static ScheduleResult simulate(std::vector<Process> procs, int quantum, GanttSink* sink = nullptr,
+                                   StatsDetail detail = StatsDetail::Summary);
 
-    static void compute_stats(std::vector<Process>& done, ScheduleResult& out);
+    // Expand ScheduleResult::rounds back into per-quantum slices, in time
+    // order: O(n log n) plus one step per slice
+    static std::vector<GanttSlice> expand_rounds(const ScheduleResult& r);
+    static void expand_rounds(const ScheduleResult& r, const std::function<void(const GanttSlice&)>& fn);
+
+    // Fills stats, the averages, deadline misses and (PerProcess) per_process
+    // from finished processes; shared with MultiCoreScheduler
+    static void compute_stats(const std::vector<Process>& done, ScheduleResult& out, StatsDetail detail);
+
+private:
+    // sink == nullptr => slices go to the result
+    static ScheduleResult dispatch(std::vector<Process> procs, SchedPolicy policy, int quantum, GanttSink* sink,
+                                   StatsDetail detail);
+    static ScheduleResult priority_nonpreemptive(std::vector<Process> procs, GanttSink* sink, StatsDetail detail);
+    static ScheduleResult priority_preemptive(std::vector<Process> procs, GanttSink* sink, StatsDetail detail);
+    static ScheduleResult round_robin(std::vector<Process> procs, int quantum, GanttSink* sink, StatsDetail detail);
+    static ScheduleResult round_robin_rounds(std::vector<Process> procs, int quantum, GanttSink* sink,
+                                             StatsDetail detail);
 };
@@ -1,10 +1,64 @@
 #include "simulator.hpp"
+#include <iomanip>
 #include <iostream>
 #include <chrono>
 #include <algorithm> // for sort
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+// Slice events for the event log; compressed rounds are expanded only while logging
+static void emit_slices(const ScheduleResult& r, int cpu = 0) {
+    if (!EventLog::enabled()) return;
+    for (const auto& s : r.gantt) EventLog::emit(EventType::Slice, s.pid, s.start, s.end, cpu);
+    if (r.rounds.empty()) return;
+    Scheduler::expand_rounds(r, [&](const GanttSlice& s) {
+        EventLog::emit(EventType::Slice, s.pid, s.start, s.end, cpu);
+    });
+}
+
+void Simulator::reset_run() {
+    ready_list_.clear();
+    blocked_list_.clear();
+    wakeup_.clear();
+    indexed_ = 0;
+    pool_.clear();
+}
 
-Process Simulator::make_sentinel() {
-    return Process{-1, 0, 0, 0, {}};
+std::vector<Process> Simulator::ready_processes() const {
+    std::vector<Process> procs;
+    procs.reserve(ready_list_.size());
+    ready_list_.for_each([&](ProcessHandle h) { procs.push_back(pool_[h]); });
+    return procs;
+}
+
+void Simulator::set_dispatchers(int n) {
+    if (n < 1) throw std::invalid_argument("dispatchers must be >= 1");
+    dispatchers_ = n;
+}
+
+template <class Feed>
+uint64_t Simulator::run_dispatchers(Feed&& feed) {
+    std::unique_ptr<ConcurrentAdmission> shared;
+    if (dispatchers_ > 1) shared = std::make_unique<ConcurrentAdmission>(banker_);
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < dispatchers_; i++)
+        consumers.emplace_back(&Simulator::consumer_dispatcher, this, shared.get());
+
+    // A feed error (e.g. a bad trace record) must still stop the consumers
+    std::exception_ptr error;
+    try {
+        feed();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::vector<ProcessHandle> sentinels(static_cast<size_t>(dispatchers_), kNoProcess);
+    buffer_.push_bulk(sentinels);
+    for (auto& t : consumers) t.join();
+    if (error) std::rethrow_exception(error);
+    return shared ? shared->conflicts() : 0;
 }
 
 Simulator::Simulator(int buffer_size,
@@ -14,7 +68,8 @@ Simulator::Simulator(int buffer_size,
     : buffer_(buffer_size),
       banker_(std::move(initial_available)),
       producers_count_(producers_count),
-      processes_per_producer_(processes_per_producer) {}
+      processes_per_producer_(processes_per_producer),
+      wakeup_(banker_.available().size()) {}
 
 void Simulator::add_process(const Process& p) {
     std::lock_guard<std::mutex> lock(lists_mtx_);
@@ -30,6 +85,8 @@ void Simulator::display_state() const {
     for (int x : banker_.available()) std::cout << x << " ";
     std::cout << "\n";
 
+    std::cout << "Clock: " << clock_ << "\n";
+
     std::cout << "Manual pool: ";
     if (manual_pool_.empty()) std::cout << "(none)";
     for (auto &p : manual_pool_) std::cout << "P" << p.pid << " ";
@@ -37,16 +94,35 @@ void Simulator::display_state() const {
 
     std::cout << "Ready list: ";
     if (ready_list_.empty()) std::cout << "(none)";
-    for (auto &p : ready_list_) std::cout << "P" << p.pid << " ";
+    ready_list_.for_each([&](ProcessHandle h) { std::cout << "P" << pool_[h].pid << " "; });
     std::cout << "\n";
 
     std::cout << "Blocked list: ";
     if (blocked_list_.empty()) std::cout << "(none)";
-    for (auto &p : blocked_list_) std::cout << "P" << p.pid << " ";
+    blocked_list_.for_each([&](ProcessHandle h) { std::cout << "P" << pool_[h].pid << " "; });
     std::cout << "\n";
     std::cout << "---------------------\n";
 }
 
+void Simulator::display_metrics() const {
+    MetricsSnapshot snap = metrics();
+
+    std::cout << "\n--- Latency Metrics (us) ---\n";
+    std::cout << std::left << std::setw(18) << "probe" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p99" << std::setw(10) << "p999" << std::setw(10) << "max" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& p : snap.probes) {
+        std::cout << std::left << std::setw(18) << p.name << std::right
+                  << std::setw(10) << p.count << std::setw(10) << p.mean_ns / 1e3
+                  << std::setw(10) << p.p50_ns / 1e3 << std::setw(10) << p.p99_ns / 1e3
+                  << std::setw(10) << p.p999_ns / 1e3 << std::setw(10) << p.max_ns / 1e3 << "\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+    std::cout << "----------------------------\n";
+}
+
 void Simulator::producer_thread(int id) {
     for (int i = 0; i < processes_per_producer_; i++) {
         int pid = next_pid_.fetch_add(1);
@@ -58,60 +134,146 @@ void Simulator::producer_thread(int id) {
         int at = i;
 
         // Must match number of resource types (we use 3 in main)
-        std::vector<int> need = { pid % 3, (pid + 1) % 3, (pid + 2) % 3 };
+        ResourceVector need = { pid % 3, (pid + 1) % 3, (pid + 2) % 3 };
 
-        Process p(pid, at, burst, pr, need);
+        ProcessHandle h = pool_.create(Process(pid, at, burst, pr, need));
 
-        std::cout << "[Producer " << id << "] push PID=" << pid
-                  << " at=" << at
-                  << " burst=" << burst
-                  << " pr=" << pr << "\n";
+        if (log_on())
+            std::cout << "[Producer " << id << "] push PID=" << pid
+                      << " at=" << at
+                      << " burst=" << burst
+                      << " pr=" << pr << "\n";
 
-        buffer_.push(p);
-        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        buffer_.push(h);
+        EventLog::emit(EventType::Push, pid);
+        if (producer_delay_.count() > 0) std::this_thread::sleep_for(producer_delay_);
     }
 }
 
-void Simulator::consumer_dispatcher() {
-    while (true) {
-        Process p = buffer_.pop();
-        if (p.pid == -1) {
-            std::cout << "[Consumer] got sentinel, stopping intake.\n";
-            break;
-        }
+void Simulator::set_workload(const WorkloadConfig& cfg) {
+    if (cfg.resources != banker_.available().size())
+        throw std::invalid_argument("workload has " + std::to_string(cfg.resources) +
+                                    " resource types, banker has " +
+                                    std::to_string(banker_.available().size()));
+    workload_ = cfg;
+    streams_.clear();
+}
 
-        auto safe = banker_.request_resources(p.pid, p.max_need);
+void Simulator::generator_thread(int id, int first_pid, bool resume) {
+    WorkloadConfig cfg = *workload_;
+    cfg.count = static_cast<uint64_t>(processes_per_producer_);
+    cfg.first_pid = first_pid;
+    WorkloadGenerator gen(cfg, static_cast<uint64_t>(id));
+    GeneratorState& stream = streams_[static_cast<size_t>(id - 1)];
+    if (resume) gen.resume(stream);
+
+    std::vector<ProcessHandle> chunk;
+    chunk.reserve(kTraceChunk);
+    Process p;
+    while (gen.next(p)) {
+        if (log_on())
+            std::cout << "[Producer " << id << "] push PID=" << p.pid
+                      << " at=" << p.arrival_time
+                      << " burst=" << p.burst_time
+                      << " pr=" << p.priority << "\n";
+        EventLog::emit(EventType::Push, p.pid);
+        chunk.push_back(pool_.create(p));
+        if (chunk.size() == kTraceChunk) buffer_.push_bulk(chunk);
+    }
+    if (!chunk.empty()) buffer_.push_bulk(chunk);
+    stream = gen.state();
+}
 
-        std::lock_guard<std::mutex> lock(lists_mtx_);
-        if (safe) {
-            std::cout << "[Consumer] PID=" << p.pid << " SAFE -> ready. SafeSeq: ";
-            for (int x : *safe) std::cout << x << " ";
-            std::cout << "\n";
-            ready_list_.push_back(p);
-        } else {
-            std::cout << "[Consumer] PID=" << p.pid << " UNSAFE -> blocked.\n";
-            blocked_list_.push_back(p);
+void Simulator::consumer_dispatcher(ConcurrentAdmission* shared) {
+    std::vector<ProcessHandle> batch;
+    std::vector<const Process*> procs;
+    batch.reserve(kAdmitBatch);
+    procs.reserve(kAdmitBatch);
+    std::unique_ptr<ConcurrentAdmission::Replica> replica;
+    if (shared) replica = std::make_unique<ConcurrentAdmission::Replica>(banker_);
+    bool stop = false;
+
+    while (!stop) {
+        // Take whatever is queued (at least one) and admit it in one go
+        batch.clear();
+        buffer_.pop_bulk(batch, kAdmitBatch);
+
+        // Sentinels come after all work; one per dispatcher, so hand back
+        // any extra this batch took
+        auto sentinel = std::find(batch.begin(), batch.end(), kNoProcess);
+        if (sentinel != batch.end()) {
+            size_t extra = static_cast<size_t>(batch.end() - sentinel) - 1;
+            batch.erase(sentinel, batch.end());
+            stop = true;
+            for (size_t i = 0; i < extra; i++) buffer_.push(kNoProcess);
         }
+
+        if (!batch.empty()) {
+            procs.clear();
+            for (ProcessHandle h : batch) {
+                procs.push_back(&pool_[h]);
+                EventLog::emit(EventType::Pop, pool_[h].pid);
+            }
+            auto result = shared ? shared->admit(procs, *replica) : banker_.request_batch(procs);
+
+            bool any_safe = false;
+            for (size_t i = 0; i < batch.size(); i++) {
+                int pid = procs[i]->pid;
+                if (result.admitted[i]) {
+                    EventLog::emit(EventType::Admit, pid);
+                    if (log_on()) std::cout << "[Consumer] PID=" << pid << " SAFE -> ready.\n";
+                    ready_list_.push_back(batch[i]);
+                    any_safe = true;
+                } else {
+                    EventLog::emit(EventType::Block, pid);
+                    if (log_on()) std::cout << "[Consumer] PID=" << pid << " UNSAFE -> blocked.\n";
+                    blocked_list_.push_back(batch[i]);
+                }
+            }
+            if (any_safe && log_on()) {
+                std::cout << "[Consumer] SafeSeq: ";
+                for (int x : result.safe_sequence) std::cout << x << " ";
+                std::cout << "\n";
+            }
+        }
+
+        if (stop && log_on()) std::cout << "[Consumer] got sentinel, stopping intake.\n";
     }
 }
 
-void Simulator::try_unblock() {
-    // assumes lists_mtx_ already held by caller
-    std::vector<Process> still_blocked;
-
-    for (auto &p : blocked_list_) {
-        auto safe = banker_.request_resources(p.pid, p.max_need);
-        if (safe) {
+size_t Simulator::try_unblock() {
+    // assumes lists_mtx_ already held by caller and no dispatcher running
+    const std::vector<int>& available = banker_.available();
+    for (size_t n = blocked_list_.size(); indexed_ < n; indexed_++)
+        wakeup_.add(blocked_list_[indexed_], pool_, available);
+
+    // Only processes whose claim fits now can pass the safety check
+    wakeup_.take_fitting(pool_, available, wake_candidates_);
+    woken_.clear();
+    for (const WakeupIndex::Entry& e : wake_candidates_) {
+        const Process& p = pool_[e.h];
+        if (!banker_.admit(p.pid, p.max_need)) {
+            wakeup_.readd(e, pool_, available);
+            continue;
+        }
+        EventLog::emit(EventType::Unblock, p.pid);
+        if (log_on()) {
             std::cout << "[Unblock] PID=" << p.pid << " now SAFE. SafeSeq: ";
-            for (int x : *safe) std::cout << x << " ";
+            for (int x : banker_.safe_sequence()) std::cout << x << " ";
             std::cout << "\n";
-            ready_list_.push_back(p);
-        } else {
-            still_blocked.push_back(p);
         }
+        ready_list_.push_back(e.h);
+        woken_.push_back(e.h);
     }
 
-    blocked_list_ = std::move(still_blocked);
+    if (!woken_.empty()) {
+        std::sort(woken_.begin(), woken_.end());
+        blocked_list_.retain_if([&](ProcessHandle h) {
+            return !std::binary_search(woken_.begin(), woken_.end(), h);
+        });
+        indexed_ = blocked_list_.size();
+    }
+    return woken_.size();
 }
 
 void Simulator::print_blocked() const {
@@ -120,7 +282,7 @@ void Simulator::print_blocked() const {
         std::cout << "(none)\n";
         return;
     }
-    for (auto &p : blocked_list_) std::cout << "P" << p.pid << " ";
+    blocked_list_.for_each([&](ProcessHandle h) { std::cout << "P" << pool_[h].pid << " "; });
     std::cout << "\n";
 }
 
@@ -128,8 +290,7 @@ void Simulator::start() {
     // reset lists each run (important for menu-based repeated runs)
     {
         std::lock_guard<std::mutex> lock(lists_mtx_);
-        ready_list_.clear();
-        blocked_list_.clear();
+        reset_run();
     }
 
     std::cout << "\n=== Simulation Start ===\n";
@@ -148,24 +309,35 @@ void Simulator::start() {
     if (!manual_copy.empty()) {
         std::cout << "[Simulation] Using manual processes (" << manual_copy.size() << ")\n";
 
-        // Push manual processes then sentinel
-        for (auto &p : manual_copy) buffer_.push(p);
-        buffer_.push(make_sentinel());
+        // Push manual processes then sentinel (one batch of handles)
+        std::vector<ProcessHandle> handles;
+        for (auto& p : manual_copy) {
+            EventLog::emit(EventType::Push, p.pid);
+            handles.push_back(pool_.create(std::move(p)));
+        }
+        handles.push_back(kNoProcess);
+        buffer_.push_bulk(handles);
 
         // Run dispatcher in same thread
         consumer_dispatcher();
     } else {
-        // Threaded mode (2 producers + 1 consumer) requirement
-        std::thread consumer(&Simulator::consumer_dispatcher, this);
-
-        std::vector<std::thread> producers;
-        for (int i = 0; i < producers_count_; i++)
-            producers.emplace_back(&Simulator::producer_thread, this, i + 1);
-
-        for (auto &t : producers) t.join();
-
-        buffer_.push(make_sentinel());
-        consumer.join();
+        // Threaded mode (2 producers + dispatchers_ consumers) requirement
+        run_dispatchers([&] {
+            std::vector<std::thread> producers;
+            // Generated workloads get fixed pid blocks, so a seed always yields the same processes
+            int first_pid = workload_ ? next_pid_.fetch_add(producers_count_ * processes_per_producer_) : 0;
+            // Each producer writes only its own slot
+            bool resume = streams_.size() == static_cast<size_t>(producers_count_);
+            if (workload_ && !resume) streams_.assign(static_cast<size_t>(producers_count_), GeneratorState{});
+            for (int i = 0; i < producers_count_; i++) {
+                if (workload_)
+                    producers.emplace_back(&Simulator::generator_thread, this, i + 1,
+                                           first_pid + i * processes_per_producer_, resume);
+                else
+                    producers.emplace_back(&Simulator::producer_thread, this, i + 1);
+            }
+            for (auto &t : producers) t.join();
+        });
     }
 
     // ---- Scheduling + release + unblock ----
@@ -176,31 +348,42 @@ void Simulator::start() {
                   << " -> " << (ready_list_.size() <= 5 ? "Priority" : "Round Robin")
                   << "\n";
 
-        auto result = Scheduler::run(ready_list_, 4);
-
+        // Slices are printed as they are produced; long runs are summarised
+        // by the fixed-width timeline instead of one huge line
         std::cout << "\nGantt Chart:\n";
-        for (auto &s : result.gantt) {
-            std::cout << "| P" << s.pid << " (" << s.start << "-" << s.end << ") ";
-        }
+        AsciiTimeline timeline(kTimelineWidth);
+        size_t listed = 0;
+        CallbackGanttSink gantt([&](const GanttSlice& s) {
+            if (listed++ < kGanttListed)
+                std::cout << "| P" << s.pid << " (" << s.start << "-" << s.end << ") ";
+            timeline.add(s.pid, s.start, s.end);
+            EventLog::emit(EventType::Slice, s.pid, s.start, s.end);
+        });
+        auto result = Scheduler::run(ready_processes(), SchedPolicy::Auto, 4, gantt, StatsDetail::PerProcess);
+        timeline.finish();
+        clock_ = std::max(clock_, result.finish_time);
         std::cout << "|\n";
+        if (listed > kGanttListed) std::cout << "(" << listed - kGanttListed << " more slices)\n";
+        std::cout << timeline.render();
 
-        // PRINT WT/TAT IN SORTED PID ORDER (polish fix)
-        std::vector<int> pids;
-        pids.reserve(result.waiting.size());
-        for (auto &kv : result.waiting) pids.push_back(kv.first);
-        std::sort(pids.begin(), pids.end());
-
+        // per_process is already in pid order
         std::cout << "\nPID  WT  TAT\n";
-        for (int pid : pids) {
-            std::cout << pid << "   " << result.waiting.at(pid)
-                      << "   " << result.turnaround.at(pid) << "\n";
-        }
+        for (const ProcessTimes& t : result.per_process)
+            std::cout << t.pid << "   " << t.waiting << "   " << t.turnaround << "\n";
 
         std::cout << "\nAverage WT=" << result.avg_waiting
                   << "  Average TAT=" << result.avg_turnaround << "\n";
+        auto tail = [](const char* name, const StreamingStat& s) {
+            std::cout << name << " p50/p95/p99=" << s.percentile(0.50) << "/" << s.percentile(0.95) << "/"
+                      << s.percentile(0.99) << "  ";
+        };
+        tail("WT", result.stats.waiting);
+        tail("TAT", result.stats.turnaround);
+        tail("RT", result.stats.response);
+        std::cout << "\n";
 
         // Release resources for finished processes
-        for (auto &p : ready_list_) banker_.release_all(p.pid);
+        ready_list_.for_each([&](ProcessHandle h) { banker_.release_all(pool_[h].pid); });
 
         // try to unblock after resources are released
         try_unblock();
@@ -209,3 +392,76 @@ void Simulator::start() {
 
     std::cout << "\n=== Simulation End ===\n";
 }
+
+RunReport Simulator::replay(TraceSource& src, SchedPolicy policy, int quantum, GanttSink* sink) {
+    using clock = std::chrono::steady_clock;
+    RunReport report;
+    {
+        std::lock_guard<std::mutex> lock(lists_mtx_);
+        reset_run();
+    }
+
+    // ---- Intake: the trace is a sequential cursor, so one producer feeds the ring ----
+    auto t0 = clock::now();
+    report.dispatchers = dispatchers_;
+    report.admission_conflicts = run_dispatchers([&] {
+        std::vector<ProcessHandle> chunk;
+        chunk.reserve(kTraceChunk);
+        Process p;
+        while (src.next(p)) {
+            EventLog::emit(EventType::Push, p.pid);
+            chunk.push_back(pool_.create(p));
+            report.processes++;
+            if (chunk.size() == kTraceChunk) buffer_.push_bulk(chunk);
+        }
+        if (!chunk.empty()) buffer_.push_bulk(chunk);
+    });
+    auto t1 = clock::now();
+
+    // ---- Scheduling + release + unblock ----
+    std::lock_guard<std::mutex> lock(lists_mtx_);
+    report.admitted = ready_list_.size();
+    report.blocked = blocked_list_.size();
+
+    if (multicore_) {
+        MultiCoreConfig cfg = multicore_cfg_;
+        cfg.quantum = quantum;
+        cfg.detail = stats_detail_;
+        report.multicore = MultiCoreScheduler::run(ready_processes(), cfg);
+        if (EventLog::enabled()) {
+            for (size_t c = 0; c < report.multicore.cores.size(); c++)
+                for (const auto& s : report.multicore.cores[c].gantt)
+                    EventLog::emit(EventType::Slice, s.pid, s.start, s.end, static_cast<int>(c));
+        }
+        report.schedule = report.multicore.total;
+    } else if (sink) {
+        CallbackGanttSink tee([&](const GanttSlice& s) {
+            EventLog::emit(EventType::Slice, s.pid, s.start, s.end);
+            sink->add(s.pid, s.start, s.end);
+        });
+        report.schedule = Scheduler::run(ready_processes(), policy, quantum, tee, stats_detail_);
+        sink->finish();
+    } else {
+        report.schedule = Scheduler::run(ready_processes(), policy, quantum, stats_detail_);
+        emit_slices(report.schedule);
+    }
+    auto t2 = clock::now();
+    clock_ = std::max(clock_, report.schedule.finish_time);
+
+    ready_list_.for_each([&](ProcessHandle h) { banker_.release_all(pool_[h].pid); });
+    report.unblocked = try_unblock();
+
+    report.intake_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    report.schedule_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    return report;
+}
+
+OnlineReport Simulator::run_online(TraceSource& src, SchedPolicy policy, int quantum, GanttSink* sink) {
+    OnlineConfig cfg;
+    cfg.policy = policy;
+    cfg.quantum = quantum;
+    cfg.cpus = multicore_ ? multicore_cfg_.cores : 1;
+    cfg.wakeup = wakeup_.order();
+    OnlineSimulator online(banker_.total(), cfg);
+    return online.run(src, sink);
+}
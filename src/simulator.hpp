@@ -2,12 +2,45 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <mutex>
+#include <optional>
+#include <string>
 
 #include "ready_buffer.hpp"
 #include "bankers.hpp"
+#include "admission.hpp"
+#include "event_log.hpp"
+#include "gantt.hpp"
+#include "metrics.hpp"
+#include "multicore.hpp"
+#include "online.hpp"
 #include "scheduler.hpp"
 #include "process.hpp"
+#include "process_pool.hpp"
+#include "trace.hpp"
+#include "wakeup_index.hpp"
+#include "workload.hpp"
+
+// Console logging of the simulation threads. Build with -DMOS_CONSOLE_LOG=0
+// to compile it out; the binary event log (event_log.hpp) is unaffected.
+#ifndef MOS_CONSOLE_LOG
+#define MOS_CONSOLE_LOG 1
+#endif
+
+// Machine-readable outcome of a headless replay
+struct RunReport {
+    size_t processes{0};
+    size_t admitted{0};        // safe at intake
+    size_t blocked{0};         // unsafe at intake
+    size_t unblocked{0};       // admitted after the release
+    ScheduleResult schedule;   // of the processes admitted at intake
+    MultiCoreResult multicore; // per-core view when replayed on several cores
+    double intake_ms{0};
+    double schedule_ms{0};
+    int dispatchers{1};
+    uint64_t admission_conflicts{0}; // optimistic commits retried (dispatchers > 1)
+};
 
 class Simulator {
 public:
@@ -19,22 +52,106 @@ public:
     // Runs one full simulation cycle
     void start();
 
+    // Headless run: stream every process of the trace through intake,
+    // admission, scheduling and release. Nothing is printed unless verbose.
+    // With a sink the slices are streamed there and report.schedule has no
+    // Gantt (single-CPU runs only).
+    RunReport replay(TraceSource& src, SchedPolicy policy, int quantum, GanttSink* sink = nullptr);
+
+    // Online variant of replay (see online.hpp): intake, admission, running
+    // and release overlap on one simulated clock, so blocked processes run
+    // once a completion frees their claim. Uses the initial resources, the
+    // wakeup order and, after set_multicore, that many CPUs.
+    OnlineReport run_online(TraceSource& src, SchedPolicy policy, int quantum, GanttSink* sink = nullptr);
+
+    // Per-process console logging (on for the interactive menu)
+    void set_verbose(bool v) { verbose_ = v; }
+
+    // Pause between two pushes of a generated producer (demo pacing)
+    void set_producer_delay(std::chrono::milliseconds d) { producer_delay_ = d; }
+
+    // Producers draw from seeded generators (stream = producer id) instead
+    // of the demo pattern, and push in bulk without pacing. Throws
+    // invalid_argument if cfg.resources differs from the banker's.
+    void set_workload(const WorkloadConfig& cfg);
+
+    // Schedule replays on cfg.cores CPUs (round robin per core, quantum from replay)
+    void set_multicore(const MultiCoreConfig& cfg) { multicore_ = true; multicore_cfg_ = cfg; }
+
+    // Dispatcher threads draining the ready buffer. With more than one,
+    // admission is optimistic (see admission.hpp); throws invalid_argument if n < 1.
+    void set_dispatchers(int n);
+
+    // Retry order of blocked processes once a release makes their claim fit
+    void set_wakeup_order(WakeupOrder order) { wakeup_.set_order(order); }
+
+    // Whether replay() keeps a ProcessTimes per scheduled process in
+    // RunReport::schedule.per_process (the summaries are always kept)
+    void set_stats_detail(StatsDetail detail) { stats_detail_ = detail; }
+
+    // Snapshot of the banker, the process records of the last run, the
+    // ready/blocked lists, the manual pool, the next pid, the simulated
+    // clock, the workload with the state of each producer's generator and
+    // the admission settings, as a versioned flat file (checkpoint.hpp).
+    // Not while a run is in progress. Throws runtime_error on I/O errors.
+    void save_checkpoint(const std::string& path) const;
+    // Replaces all of that with a snapshot (memory-mapped, copied section
+    // by section); a bad file throws runtime_error and changes nothing
+    void restore_checkpoint(const std::string& path);
+
     // Menu actions
     void add_process(const Process& p);
     void display_state() const;
+    void display_metrics() const;
+
+    // Hot-path latency histograms merged across threads
+    MetricsSnapshot metrics() const { return Metrics::snapshot(); }
 
 private:
-    ReadyBuffer buffer_;
+    // Max processes popped from the buffer and admitted per request_batch call
+    static constexpr size_t kAdmitBatch = 64;
+    // Processes read from a trace per push_bulk
+    static constexpr size_t kTraceChunk = 256;
+    // Menu output: slices listed one by one, then only the timeline
+    static constexpr size_t kGanttListed = 32;
+    static constexpr int kTimelineWidth = 72;
+
+    // Records of the current run live in pool_; the ring and the lists
+    // below only carry handles. The pool is reset at the start of each run.
+    ProcessPool pool_;
+    HandleBuffer buffer_;
     Bankers banker_;
 
     int producers_count_;
     int processes_per_producer_;
 
     std::atomic<int> next_pid_{1};
+    bool verbose_{true};
+    std::chrono::milliseconds producer_delay_{80};
+    static constexpr bool kConsoleLog = MOS_CONSOLE_LOG;
+    bool log_on() const { return kConsoleLog && verbose_; }
+    bool multicore_{false};
+    MultiCoreConfig multicore_cfg_;
+    int dispatchers_{1};
+    StatsDetail stats_detail_{StatsDetail::Summary};
+    std::optional<WorkloadConfig> workload_;
+    // Where each producer's generator stopped (index = producer id - 1):
+    // the next run continues these streams instead of repeating them.
+    // Empty until the first generated run.
+    std::vector<GeneratorState> streams_;
+    // Simulated time reached: the finish time of the last scheduled run
+    int clock_{0};
 
-    // Lists for integration
-    std::vector<Process> ready_list_;
-    std::vector<Process> blocked_list_;
+    // Lists for integration (handles into pool_). Dispatchers append to
+    // them concurrently without taking lists_mtx_.
+    HandleList ready_list_;
+    HandleList blocked_list_;
+    // blocked_list_[0, indexed_) is in wakeup_; the rest is indexed by the
+    // next try_unblock
+    WakeupIndex wakeup_;
+    size_t indexed_{0};
+    std::vector<WakeupIndex::Entry> wake_candidates_;
+    std::vector<ProcessHandle> woken_;
 
     // Processes added via menu before "Start Simulation"
     std::vector<Process> manual_pool_;
@@ -44,13 +161,21 @@ private:
 
     // Thread functions
     void producer_thread(int id);
-    void consumer_dispatcher();
+    // resume: continue streams_[id - 1] instead of starting the stream afresh
+    void generator_thread(int id, int first_pid, bool resume);
+    // shared: optimistic admission when several dispatchers run, else null
+    void consumer_dispatcher(ConcurrentAdmission* shared = nullptr);
+    // Runs dispatchers_ dispatchers while feed() pushes the work, then one
+    // sentinel per dispatcher; returns the admission conflicts
+    template <class Feed>
+    uint64_t run_dispatchers(Feed&& feed);
 
     // Blocked handling
-    void try_unblock();
+    size_t try_unblock(); // returns how many were admitted
     void print_blocked() const;
 
     // Helpers
-    static Process make_sentinel();
+    void reset_run();                         // caller holds lists_mtx_
+    std::vector<Process> ready_processes() const;
 };
 
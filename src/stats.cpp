@@ -0,0 +1,56 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <cmath>
+
+void StreamingStat::add(long long x) {
+    if (n_ == 0 || x < min_) min_ = x;
+    if (n_ == 0 || x > max_) max_ = x;
+    n_++;
+    sum_ += x;
+    double d = static_cast<double>(x) - mean_;
+    mean_ += d / static_cast<double>(n_);
+    m2_ += d * (static_cast<double>(x) - mean_);
+    sketch_.record(x > 0 ? static_cast<uint64_t>(x) : 0);
+}
+
+// Chan et al.: combine the two (count, mean, M2) triples directly
+void StreamingStat::merge(const StreamingStat& o) {
+    if (o.n_ == 0) return;
+    if (n_ == 0) {
+        *this = o;
+        return;
+    }
+    double na = static_cast<double>(n_), nb = static_cast<double>(o.n_);
+    double d = o.mean_ - mean_;
+    mean_ += d * nb / (na + nb);
+    m2_ += o.m2_ + d * d * na * nb / (na + nb);
+    n_ += o.n_;
+    sum_ += o.sum_;
+    min_ = std::min(min_, o.min_);
+    max_ = std::max(max_, o.max_);
+    sketch_.merge(o.sketch_);
+}
+
+double StreamingStat::stddev() const {
+    return std::sqrt(variance());
+}
+
+long long StreamingStat::percentile(double p) const {
+    if (n_ == 0) return 0;
+    long long v = static_cast<long long>(sketch_.percentile(p));
+    return std::min(std::max(v, min_), max_);
+}
+
+void ScheduleStats::add(const Process& p) {
+    int tat = p.finish_time - p.arrival_time;
+    int start = p.start_time >= 0 ? p.start_time : p.finish_time;   // a zero burst never runs
+    waiting.add(tat - p.burst_time);
+    turnaround.add(tat);
+    response.add(start - p.arrival_time);
+}
+
+void ScheduleStats::merge(const ScheduleStats& o) {
+    waiting.merge(o.waiting);
+    turnaround.merge(o.turnaround);
+    response.merge(o.response);
+}
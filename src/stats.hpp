@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "metrics.hpp"
+#include "process.hpp"
+
+// Streaming summary of one per-process quantity in O(1) memory: exact
+// count/sum/min/max, Welford's running variance, and a mergeable quantile
+// sketch (the log-linear buckets of LatencyHistogram, relative error
+// < 6.25%). Two summaries merge exactly, e.g. across cores or sweep rows.
+class StreamingStat {
+public:
+    void add(long long x);
+    void merge(const StreamingStat& o);
+
+    uint64_t count() const { return n_; }
+    long long sum() const { return sum_; }
+    double mean() const { return n_ ? static_cast<double>(sum_) / n_ : 0.0; }
+    double variance() const { return n_ ? m2_ / n_ : 0.0; }   // population
+    double stddev() const;
+    long long min() const { return n_ ? min_ : 0; }
+    long long max() const { return n_ ? max_ : 0; }
+    // p in [0, 1]; upper bound of the bucket holding that rank, within [min, max]
+    long long percentile(double p) const;
+
+private:
+    uint64_t n_{0};
+    long long sum_{0};
+    double mean_{0};   // Welford state
+    double m2_{0};
+    long long min_{0};
+    long long max_{0};
+    LatencyHistogram sketch_;   // values below 0 are counted as 0
+};
+
+// Waiting, turnaround and response time of finished processes
+struct ScheduleStats {
+    StreamingStat waiting;      // turnaround - burst
+    StreamingStat turnaround;   // finish - arrival
+    StreamingStat response;     // first run - arrival
+
+    void add(const Process& p);
+    void merge(const ScheduleStats& o);
+};
+
+// One finished process, for StatsDetail::PerProcess
+struct ProcessTimes {
+    int pid;
+    int waiting;
+    int turnaround;
+    int response;
+};
@@ -0,0 +1,69 @@
+#include "sweep.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "bankers.hpp"
+#include "thread_pool.hpp"
+
+// Mirrors the dispatcher: arrival-ordered batches through request_batch
+static std::vector<Process> admit(const std::vector<Process>& workload,
+                                  const std::vector<int>& available) {
+    constexpr size_t kBatch = 64;
+    Bankers banker(available);
+    std::vector<Process> admitted;
+    std::vector<Process> batch;
+    batch.reserve(kBatch);
+
+    for (size_t start = 0; start < workload.size(); start += kBatch) {
+        size_t end = std::min(workload.size(), start + kBatch);
+        batch.assign(workload.begin() + start, workload.begin() + end);
+        auto res = banker.request_batch(batch);
+        for (size_t i = 0; i < batch.size(); i++)
+            if (res.admitted[i]) admitted.push_back(std::move(batch[i]));
+    }
+    return admitted;
+}
+
+std::vector<SweepRow> run_sweep(std::shared_ptr<const std::vector<Process>> workload,
+                                const std::vector<SweepConfig>& grid,
+                                unsigned threads) {
+    if (!workload) throw std::invalid_argument("sweep needs a workload");
+
+    WorkStealingPool pool(threads);
+
+    // Admission only depends on the available vector: run it once per
+    // distinct vector, then share the admitted set between configurations
+    std::vector<std::vector<int>> availables;
+    std::vector<size_t> admit_of(grid.size());
+    for (size_t i = 0; i < grid.size(); i++) {
+        auto it = std::find(availables.begin(), availables.end(), grid[i].available);
+        admit_of[i] = static_cast<size_t>(it - availables.begin());
+        if (it == availables.end()) availables.push_back(grid[i].available);
+    }
+
+    std::vector<std::shared_ptr<const std::vector<Process>>> admitted(availables.size());
+    pool.parallel_for(availables.size(), [&](size_t a) {
+        admitted[a] = availables[a].empty()
+                    ? workload
+                    : std::make_shared<const std::vector<Process>>(admit(*workload, availables[a]));
+    });
+
+    std::vector<SweepRow> rows(grid.size());
+    pool.parallel_for(grid.size(), [&](size_t i) {
+        auto t0 = std::chrono::steady_clock::now();
+        const SweepConfig& cfg = grid[i];
+        SweepRow& row = rows[i];
+        row.config = cfg;
+
+        // Each run schedules its own copy; the shared sets are never written
+        const auto& procs = *admitted[admit_of[i]];
+        row.admitted = procs.size();
+
+        ScheduleResult res = Scheduler::run(procs, cfg.policy, cfg.quantum);
+        row.avg_waiting = res.avg_waiting;
+        row.avg_turnaround = res.avg_turnaround;
+        row.makespan = res.finish_time;
+        row.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    });
+    return rows;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "process.hpp"
+#include "scheduler.hpp"
+
+// One point of a parameter sweep. An empty `available` skips admission and
+// schedules the whole workload.
+struct SweepConfig {
+    SchedPolicy policy{SchedPolicy::Auto};
+    int quantum{4};
+    std::vector<int> available;
+};
+
+struct SweepRow {
+    SweepConfig config;
+    size_t admitted{0};
+    double avg_waiting{0};
+    double avg_turnaround{0};
+    int makespan{0};
+    double ms{0};          // wall time of scheduling (admission is shared)
+};
+
+// Runs every configuration against the same immutable workload, spread over
+// a work-stealing pool (threads = 0 => one per core). Admission runs once per
+// distinct available vector. Rows come back in grid order.
+std::vector<SweepRow> run_sweep(std::shared_ptr<const std::vector<Process>> workload,
+                                const std::vector<SweepConfig>& grid,
+                                unsigned threads = 0);
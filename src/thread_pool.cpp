@@ -0,0 +1,93 @@
+#include "thread_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; i++) queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < threads; i++) workers_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+bool WorkStealingPool::take(unsigned id, size_t& out) {
+    {
+        Queue& own = *queues_[id];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (!own.items.empty()) {
+            out = own.items.back();
+            own.items.pop_back();
+            return true;
+        }
+    }
+    // steal, starting with the next worker so thieves spread out
+    for (size_t k = 1; k < queues_.size(); k++) {
+        Queue& victim = *queues_[(id + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.items.empty()) {
+            out = victim.items.front();
+            victim.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(unsigned id) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            work_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+
+        size_t i;
+        while (take(id, i)) {
+            try {
+                (*body_.load())(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (!error_) error_ = std::current_exception();
+            }
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mtx_);
+                done_cv_.notify_all();
+            }
+        }
+    }
+}
+
+void WorkStealingPool::parallel_for(size_t n, const std::function<void(size_t)>& body) {
+    if (n == 0) return;
+
+    body_.store(&body);
+    pending_.store(n);
+
+    // Contiguous chunks per worker; owners work from the back, thieves from the front
+    size_t w = queues_.size();
+    for (size_t q = 0; q < w; q++) {
+        std::lock_guard<std::mutex> lock(queues_[q]->mtx);
+        for (size_t i = q * n / w; i < (q + 1) * n / w; i++) queues_[q]->items.push_back(i);
+    }
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    generation_++;
+    work_cv_.notify_all();
+    done_cv_.wait(lock, [&] { return pending_.load() == 0; });
+
+    body_.store(nullptr);
+    if (error_) {
+        std::exception_ptr e = error_;
+        error_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one deque of task indices per worker.
+// A worker pops from the back of its own deque and, once that is empty,
+// steals from the front of the others, so uneven task costs even out.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = 0); // 0 => hardware_concurrency
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Run body(i) for every i in [0, n) and wait for all of them.
+    // The first exception thrown by a task is rethrown here.
+    void parallel_for(size_t n, const std::function<void(size_t)>& body);
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mtx;
+        std::deque<size_t> items;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+
+    std::mutex mtx_;                 // protects job state below
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    // Read after taking an item: a worker still draining the previous job may
+    // pick up items of the next one
+    std::atomic<const std::function<void(size_t)>*> body_{nullptr};
+    unsigned long generation_{0};
+    bool stop_{false};
+
+    std::atomic<size_t> pending_{0};
+    std::exception_ptr error_;
+
+    void worker_loop(unsigned id);
+    bool take(unsigned id, size_t& out);
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Event queue over a monotonic integer clock. Events due within the next
+// 2^SlotBits time units sit in the bucket of their time (a bucket only ever
+// holds one time), found through an occupancy bitmap; later ones wait in an
+// overflow heap and drop into the wheel as the clock gets close. Scheduling
+// and popping a near event is O(1) (the bitmap scan is bounded by
+// 2^SlotBits / 64 words); only events further out than the wheel pay
+// O(log n) for the heap.
+template <class T, unsigned SlotBits = 12>
+class TimingWheel {
+public:
+    static constexpr long long kSlots = 1LL << SlotBits;
+
+    TimingWheel() : buckets_(kSlots), bits_(kSlots / 64, 0) {}
+
+    long long now() const { return now_; }
+    size_t size() const { return wheel_count_ + overflow_.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Throws invalid_argument for a time in the past
+    void schedule(long long time, T item) {
+        if (time < now_) throw std::invalid_argument("timing wheel: event in the past");
+        if (time - now_ < kSlots) {
+            put(time, std::move(item));
+        } else {
+            overflow_.push_back({time, far_seq_++, std::move(item)});
+            std::push_heap(overflow_.begin(), overflow_.end(), later);
+        }
+    }
+
+    // Advances the clock to the earliest pending time and appends every
+    // event due then to out, in scheduling order; false when empty
+    bool pop_next(std::vector<T>& out, long long& time) {
+        if (empty()) return false;
+        long long t = wheel_count_ ? next_in_wheel() : overflow_.front().time;
+        if (!overflow_.empty() && overflow_.front().time < t) t = overflow_.front().time;
+        now_ = t;
+
+        // Overflow events now within reach of the wheel
+        while (!overflow_.empty() && overflow_.front().time - now_ < kSlots) {
+            std::pop_heap(overflow_.begin(), overflow_.end(), later);
+            put(overflow_.back().time, std::move(overflow_.back().item));
+            overflow_.pop_back();
+        }
+
+        size_t slot = static_cast<size_t>(t & (kSlots - 1));
+        auto& bucket = buckets_[slot];
+        for (auto& item : bucket) out.push_back(std::move(item));
+        wheel_count_ -= bucket.size();
+        bucket.clear();
+        bits_[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+        time = t;
+        return true;
+    }
+
+    // Drops every event and restarts the clock at 0 (keeps the buckets)
+    void clear() {
+        for (auto& bucket : buckets_) bucket.clear();
+        std::fill(bits_.begin(), bits_.end(), 0);
+        overflow_.clear();
+        wheel_count_ = 0;
+        now_ = 0;
+    }
+
+private:
+    std::vector<std::vector<T>> buckets_;
+    std::vector<uint64_t> bits_;                      // non-empty buckets
+    // Far events, min-heap on (time, seq) so equal times keep their order
+    struct Far {
+        long long time;
+        uint64_t seq;
+        T item;
+    };
+    std::vector<Far> overflow_;
+    uint64_t far_seq_{0};
+    size_t wheel_count_{0};
+    long long now_{0};
+
+    static bool later(const Far& a, const Far& b) {
+        return a.time != b.time ? a.time > b.time : a.seq > b.seq;
+    }
+
+    void put(long long time, T item) {
+        size_t slot = static_cast<size_t>(time & (kSlots - 1));
+        buckets_[slot].push_back(std::move(item));
+        bits_[slot / 64] |= uint64_t{1} << (slot % 64);
+        wheel_count_++;
+    }
+
+    // Earliest time in the wheel: first set bit at or after now_'s slot, wrapping
+    long long next_in_wheel() const {
+        const size_t words = bits_.size();
+        size_t start = static_cast<size_t>(now_ & (kSlots - 1));
+        size_t w = start / 64;
+        uint64_t word = bits_[w] & (~uint64_t{0} << (start % 64));
+        for (size_t k = 0; k <= words; k++) {
+            if (word) {
+                size_t slot = w * 64 + static_cast<size_t>(__builtin_ctzll(word));
+                long long ahead = (static_cast<long long>(slot) - static_cast<long long>(start) + kSlots) &
+                                  (kSlots - 1);
+                return now_ + ahead;
+            }
+            w = (w + 1) % words;
+            word = bits_[w];
+            // Back at the first word: only the bits before start are left
+            if (k + 1 == words) word &= (start % 64) ? ~(~uint64_t{0} << (start % 64)) : 0;
+        }
+        return now_;   // unreachable while wheel_count_ > 0
+    }
+};
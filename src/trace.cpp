@@ -0,0 +1,266 @@
+#include "trace.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kTraceMagic[8] = {'M', 'O', 'S', 'T', 'R', 'A', 'C', 'E'};
+
+// ---------------- BinaryTrace ----------------
+
+BinaryTrace::BinaryTrace(const std::string& path) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open trace " + path + ": " + std::strerror(errno));
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat trace " + path);
+    }
+    map_len_ = static_cast<size_t>(st.st_size);
+    if (map_len_ < sizeof(TraceHeader)) {
+        ::close(fd);
+        throw std::runtime_error("trace too small: " + path);
+    }
+
+    map_ = mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        throw std::runtime_error("mmap failed for trace " + path);
+    }
+    // Records are consumed front to back exactly once
+    madvise(map_, map_len_, MADV_SEQUENTIAL);
+
+    TraceHeader h;
+    std::memcpy(&h, map_, sizeof h);
+    if (std::memcmp(h.magic, kTraceMagic, sizeof kTraceMagic) != 0 || h.version == 0 || h.version > kTraceVersion) {
+        munmap(map_, map_len_);
+        throw std::runtime_error("not a version 1 to " + std::to_string(kTraceVersion) + " trace: " + path);
+    }
+
+    fixed_ = h.version + 3;
+    has_io_ = h.version >= 3;
+    m_ = h.resources;
+    count_ = h.count;
+    // Bounded by division: a crafted count or width must not wrap the size.
+    // I/O requests only lengthen records, so next() checks those itself.
+    bool fits = m_ != 0 && m_ <= SIZE_MAX / sizeof(int32_t) - fixed_;
+    if (fits) fits = count_ <= (map_len_ - sizeof(TraceHeader)) / ((fixed_ + m_) * sizeof(int32_t));
+    if (!fits) {
+        munmap(map_, map_len_);
+        throw std::runtime_error("truncated trace: " + path);
+    }
+    cur_ = reinterpret_cast<const int32_t*>(static_cast<const char*>(map_) + sizeof(TraceHeader));
+    end_ = cur_ + (map_len_ - sizeof(TraceHeader)) / sizeof(int32_t);
+}
+
+BinaryTrace::~BinaryTrace() {
+    if (map_) munmap(map_, map_len_);
+}
+
+bool BinaryTrace::next(Process& out) {
+    if (pos_ == count_) return false;
+    const int32_t* r = cur_;
+    pos_++;
+    if (static_cast<size_t>(end_ - r) < fixed_ + m_)
+        throw std::runtime_error(path_ + ": record " + std::to_string(pos_) + ": truncated");
+    size_t io = 0;
+    if (has_io_) {
+        if (r[5] < 0) throw std::runtime_error(path_ + ": record " + std::to_string(pos_) + ": negative I/O count");
+        io = static_cast<size_t>(r[5]);
+        if (io > (static_cast<size_t>(end_ - r) - fixed_ - m_) / 3)
+            throw std::runtime_error(path_ + ": record " + std::to_string(pos_) + ": truncated I/O requests");
+    }
+    cur_ = r + fixed_ + m_ + 3 * io;
+    if (r[1] < 0 || r[2] < 0)
+        throw std::runtime_error(path_ + ": record " + std::to_string(pos_) + ": negative arrival or burst");
+
+    out.pid = r[0];
+    out.arrival_time = r[1];
+    out.burst_time = r[2];
+    out.remaining_time = r[2];
+    out.priority = r[3];
+    out.deadline = fixed_ > 4 ? r[4] : -1;
+    out.max_need.assign(r + fixed_, r + fixed_ + m_);
+    out.io.clear();
+    for (const int32_t* q = r + fixed_ + m_; q != cur_; q += 3) out.io.push_back({q[0], q[1], q[2]});
+    out.start_time = -1;
+    out.finish_time = -1;
+    return true;
+}
+
+// ---------------- CsvTrace ----------------
+
+namespace {
+
+// Column i of a comma-separated header line, trimmed
+std::string header_column(const char* p, size_t i) {
+    for (; i > 0; i--) {
+        p = std::strchr(p, ',');
+        if (!p) return "";
+        p++;
+    }
+    while (*p == ' ' || *p == '\t') p++;
+    const char* end = p;
+    while (*end && *end != ',' && *end != ' ' && *end != '\t' && *end != '\r') end++;
+    return std::string(p, end);
+}
+
+// Parses the "at:duration:device;..." items of an io column into io and
+// returns the end of the field; nullptr on a malformed item
+const char* parse_io(const char* p, std::vector<IoRequest>& io) {
+    io.clear();
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == ',' || *p == '\0' || *p == '\r') return p;
+    while (true) {
+        int v[3];
+        for (int k = 0; k < 3; k++) {
+            char* end;
+            errno = 0;
+            long x = std::strtol(p, &end, 10);
+            if (end == p || errno != 0 || x < INT32_MIN || x > INT32_MAX) return nullptr;
+            v[k] = static_cast<int>(x);
+            p = end;
+            if (k < 2 && *p++ != ':') return nullptr;
+        }
+        io.push_back({v[0], v[1], v[2]});
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p != ';') return p;
+        p++;
+    }
+}
+
+} // namespace
+
+CsvTrace::CsvTrace(const std::string& path) : in_(path), path_(path) {
+    if (!in_) throw std::runtime_error("cannot open trace " + path);
+    // m is the width of the first record; later records must match it
+    have_first_ = read_record(first_);
+    if (!have_first_) throw std::runtime_error("empty trace: " + path);
+    m_ = first_.max_need.size();
+}
+
+bool CsvTrace::read_record(Process& out) {
+    while (std::getline(in_, line_)) {
+        line_no_++;
+        const char* p = line_.c_str();
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\r' || *p == '#') continue;
+        // header line (only allowed before the first record)
+        if (m_ == 0 && !have_first_ && !(*p == '-' || (*p >= '0' && *p <= '9'))) {
+            has_deadline_ = header_column(p, 4) == "deadline";
+            has_io_ = header_column(p, has_deadline_ ? 5 : 4) == "io";
+            continue;
+        }
+
+        const size_t fixed = has_deadline_ ? 5 : 4;
+        int fields[5];
+        const size_t io_column = has_io_ ? fixed : SIZE_MAX;
+        out.max_need.clear();
+        out.io.clear();
+        size_t nf = 0;
+        while (true) {
+            if (nf == io_column) {
+                p = parse_io(p, out.io);
+                if (!p) throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": bad I/O request");
+                nf++;
+                if (*p == ',') { p++; continue; }
+                if (*p == '\0' || *p == '\r') break;
+                throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": unexpected character");
+            }
+            char* end;
+            errno = 0;
+            long v = std::strtol(p, &end, 10);
+            if (end == p || errno != 0 || v < INT32_MIN || v > INT32_MAX)
+                throw std::runtime_error(path_ + ":" + std::to_string(line_no_) +
+                                         (end == p ? ": bad number" : ": number out of range"));
+            if (nf < fixed) fields[nf] = static_cast<int>(v);
+            else out.max_need.push_back(static_cast<int>(v));
+            nf++;
+
+            p = end;
+            while (*p == ' ' || *p == '\t') p++;
+            if (*p == ',') { p++; continue; }
+            if (*p == '\0' || *p == '\r') break;
+            throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": unexpected character");
+        }
+        if (nf < fixed + (has_io_ ? 2 : 1))
+            throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": expected pid,arrival,burst,priority," +
+                                     (has_deadline_ ? "deadline," : "") + (has_io_ ? "io," : "") + "claims...");
+        if (m_ != 0 && out.max_need.size() != m_)
+            throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": claim width differs from first record");
+
+        if (fields[1] < 0 || fields[2] < 0)
+            throw std::runtime_error(path_ + ":" + std::to_string(line_no_) + ": negative arrival or burst");
+
+        out.pid = fields[0];
+        out.arrival_time = fields[1];
+        out.burst_time = fields[2];
+        out.remaining_time = fields[2];
+        out.priority = fields[3];
+        out.deadline = has_deadline_ ? fields[4] : -1;
+        out.start_time = -1;
+        out.finish_time = -1;
+        return true;
+    }
+    return false;
+}
+
+bool CsvTrace::next(Process& out) {
+    if (have_first_) {
+        have_first_ = false;
+        out = std::move(first_);
+        return true;
+    }
+    return read_record(out);
+}
+
+// ---------------- helpers ----------------
+
+std::unique_ptr<TraceSource> open_trace(const std::string& path) {
+    char magic[sizeof kTraceMagic] = {};
+    {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) throw std::runtime_error("cannot open trace " + path);
+        f.read(magic, sizeof magic);
+    }
+    if (std::memcmp(magic, kTraceMagic, sizeof kTraceMagic) == 0)
+        return std::make_unique<BinaryTrace>(path);
+    return std::make_unique<CsvTrace>(path);
+}
+
+size_t write_binary_trace(const std::string& path, TraceSource& src) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("cannot create trace " + path);
+
+    TraceHeader h{};
+    std::memcpy(h.magic, kTraceMagic, sizeof kTraceMagic);
+    h.version = kTraceVersion;
+    h.resources = static_cast<uint32_t>(src.resources());
+    h.count = 0;
+    out.write(reinterpret_cast<const char*>(&h), sizeof h); // count patched at the end
+
+    size_t m = src.resources();
+    std::vector<int32_t> rec;
+    Process p;
+    while (src.next(p)) {
+        if (p.max_need.size() != m) throw std::runtime_error("claim width differs from trace width");
+        rec.assign({p.pid, p.arrival_time, p.burst_time, p.priority, p.deadline, static_cast<int32_t>(p.io.size())});
+        rec.insert(rec.end(), p.max_need.begin(), p.max_need.end());
+        for (const IoRequest& q : p.io) rec.insert(rec.end(), {q.at, q.duration, q.device});
+        out.write(reinterpret_cast<const char*>(rec.data()), rec.size() * sizeof(int32_t));
+        h.count++;
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    if (!out) throw std::runtime_error("write failed for trace " + path);
+    return h.count;
+}
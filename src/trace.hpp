@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "process.hpp"
+
+// Workload traces for headless (batch) runs.
+//
+// Binary layout: TraceHeader, then `count` records of int32
+// [pid, arrival, burst, priority, deadline, io_count, claim_0 .. claim_{m-1},
+// (at, duration, device) x io_count] in host byte order (deadline -1 =>
+// none). Version 1 records lack the deadline, and versions 1 and 2 lack the
+// I/O requests, so their records have a fixed size.
+// CSV layout: one "pid,arrival,burst,priority,c1,..,cm" line per process;
+// blank lines, '#' comments and a non-numeric header line are skipped. A
+// header whose fifth column is "deadline" adds that column before the
+// claims: "pid,arrival,burst,priority,deadline,c1,..,cm". A header column
+// "io" right after the fixed ones holds the I/O requests as
+// "at:duration:device" items separated by ';' (empty for none).
+// Both readers reject a negative arrival or burst and CSV fields outside
+// int32, naming the CSV line or the 1-based binary record.
+
+constexpr uint32_t kTraceVersion = 3;
+
+struct TraceHeader {
+    char magic[8];       // "MOSTRACE"
+    uint32_t version;    // kTraceVersion
+    uint32_t resources;  // m (claim vector width)
+    uint64_t count;      // number of records
+};
+
+// Sequential cursor over a trace. next() reuses out's storage.
+class TraceSource {
+public:
+    virtual ~TraceSource() = default;
+
+    // Fills out with the next process; false at end of trace
+    virtual bool next(Process& out) = 0;
+    virtual size_t resources() const = 0;
+};
+
+// Binary trace read through mmap: no parsing, records are used in place
+class BinaryTrace : public TraceSource {
+public:
+    explicit BinaryTrace(const std::string& path);
+    ~BinaryTrace() override;
+
+    BinaryTrace(const BinaryTrace&) = delete;
+    BinaryTrace& operator=(const BinaryTrace&) = delete;
+
+    bool next(Process& out) override;
+    size_t resources() const override { return m_; }
+    size_t size() const { return count_; }
+
+private:
+    std::string path_;
+    void* map_{nullptr};
+    size_t map_len_{0};
+    const int32_t* cur_{nullptr};    // next record
+    const int32_t* end_{nullptr};
+    size_t fixed_{6};    // fields before the claims
+    bool has_io_{true};
+    size_t m_{0};
+    size_t count_{0};
+    size_t pos_{0};
+};
+
+// Streaming CSV reader (one line in memory at a time)
+class CsvTrace : public TraceSource {
+public:
+    explicit CsvTrace(const std::string& path);
+
+    bool next(Process& out) override;
+    size_t resources() const override { return m_; }
+
+private:
+    std::ifstream in_;
+    std::string path_;
+    std::string line_;
+    size_t line_no_{0};
+    size_t m_{0};
+    bool has_deadline_{false};
+    bool has_io_{false};
+
+    // First record is parsed by the constructor to learn m
+    bool have_first_{false};
+    Process first_;
+
+    bool read_record(Process& out);
+};
+
+// Opens path as binary if it starts with the trace magic, as CSV otherwise
+std::unique_ptr<TraceSource> open_trace(const std::string& path);
+
+// Drain src into a binary trace file; returns the number of records written
+size_t write_binary_trace(const std::string& path, TraceSource& src);
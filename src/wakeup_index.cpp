@@ -0,0 +1,109 @@
+#include "wakeup_index.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Heap order: smallest key on top
+bool key_greater(const WakeupIndex::Entry& a, const WakeupIndex::Entry& b) { return a.key > b.key; }
+
+// First resource the claim is short of, or m if it fits
+size_t first_short(const int* claim, const std::vector<int>& available) {
+    size_t m = available.size();
+    size_t j = 0;
+    while (j < m && claim[j] <= available[j]) j++;
+    return j;
+}
+
+} // namespace
+
+const char* wakeup_order_name(WakeupOrder order) {
+    switch (order) {
+    case WakeupOrder::Fifo:         return "fifo";
+    case WakeupOrder::SmallestNeed: return "smallest-need";
+    }
+    return "?";
+}
+
+WakeupOrder parse_wakeup_order(const std::string& name) {
+    for (WakeupOrder o : {WakeupOrder::Fifo, WakeupOrder::SmallestNeed})
+        if (name == wakeup_order_name(o)) return o;
+    throw std::invalid_argument("unknown wakeup order " + name);
+}
+
+void WakeupIndex::place(Entry e, const int* claim, const std::vector<int>& available) {
+    size_t j = first_short(claim, available);
+    if (j == heaps_.size()) parked_.push_back(e);
+    else push(j, e, claim);
+    size_++;
+}
+
+void WakeupIndex::push(size_t j, Entry e, const int* claim) {
+    e.key = claim[j];
+    heaps_[j].push_back(e);
+    std::push_heap(heaps_[j].begin(), heaps_[j].end(), key_greater);
+}
+
+void WakeupIndex::add(ProcessHandle h, const ProcessPool& pool, const std::vector<int>& available) {
+    const ResourceVector& claim = pool[h].max_need;
+    uint64_t seq = next_seq_++;
+    if (claim.size() != heaps_.size()) return;
+    long long sum = 0;
+    for (int x : claim) sum += x;
+    place({h, seq, sum, 0}, claim.data(), available);
+}
+
+void WakeupIndex::readd(Entry e, const ProcessPool& pool, const std::vector<int>& available) {
+    place(e, pool[e.h].max_need.data(), available);
+}
+
+void WakeupIndex::take_fitting(const ProcessPool& pool, const std::vector<int>& available,
+                               std::vector<Entry>& out) {
+    out.clear();
+    size_t m = heaps_.size();
+
+    // Parked entries fit when they were parked; admissions since may have used that up
+    for (const Entry& e : parked_) {
+        const int* claim = pool[e.h].max_need.data();
+        size_t j = first_short(claim, available);
+        if (j == m) out.push_back(e);
+        else push(j, e, claim);
+    }
+    size_ -= out.size();
+    parked_.clear();
+
+    // Tops that resource j no longer blocks either fit or move to the heap
+    // of another resource they are short of (one already drained here stays
+    // short, so a single pass suffices)
+    for (size_t j = 0; j < m; j++) {
+        auto& heap = heaps_[j];
+        while (!heap.empty() && heap.front().key <= available[j]) {
+            std::pop_heap(heap.begin(), heap.end(), key_greater);
+            Entry e = heap.back();
+            heap.pop_back();
+            const int* claim = pool[e.h].max_need.data();
+            size_t k = first_short(claim, available);
+            if (k == m) {
+                out.push_back(e);
+                size_--;
+            } else {
+                push(k, e, claim);
+            }
+        }
+    }
+
+    if (order_ == WakeupOrder::Fifo) {
+        std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+    } else {
+        std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) {
+            return a.size != b.size ? a.size < b.size : a.seq < b.seq;
+        });
+    }
+}
+
+void WakeupIndex::clear() {
+    for (auto& heap : heaps_) heap.clear();
+    parked_.clear();
+    next_seq_ = 0;
+    size_ = 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "process_pool.hpp"
+
+// Order in which blocked processes that fit are retried
+enum class WakeupOrder {
+    Fifo,           // order they were blocked in
+    SmallestNeed,   // smallest total claim first, ties in FIFO order
+};
+
+const char* wakeup_order_name(WakeupOrder order);
+WakeupOrder parse_wakeup_order(const std::string& name); // throws invalid_argument
+
+// Blocked processes indexed by the resource that keeps them waiting.
+//
+// A process whose claim does not fit the available vector waits in the
+// min-heap (keyed by its claim on that resource) of the first resource it
+// is short of. A claim can only fit once every resource suffices, so after
+// a release only heap tops at or below the new available amount are looked
+// at; one that is still short elsewhere moves to that resource's heap.
+// Processes that fit but were refused as unsafe are parked and offered
+// again on every take_fitting().
+class WakeupIndex {
+public:
+    struct Entry {
+        ProcessHandle h;
+        uint64_t seq;      // FIFO position
+        long long size;    // sum of the claim
+        int key;           // claim on the resource whose heap holds it
+    };
+
+    explicit WakeupIndex(size_t m) : heaps_(m) {}
+
+    void set_order(WakeupOrder order) { order_ = order; }
+    WakeupOrder order() const { return order_; }
+
+    // Indexes a newly blocked process (claims of another width never wake)
+    void add(ProcessHandle h, const ProcessPool& pool, const std::vector<int>& available);
+    // Puts back an entry from take_fitting() that was not admitted
+    void readd(Entry e, const ProcessPool& pool, const std::vector<int>& available);
+
+    // Removes the entries whose claim fits `available` and returns them in
+    // wake order (out is overwritten)
+    void take_fitting(const ProcessPool& pool, const std::vector<int>& available,
+                      std::vector<Entry>& out);
+
+    size_t size() const { return size_; }
+    void clear();
+
+private:
+    std::vector<std::vector<Entry>> heaps_;   // per resource, min-heap on key
+    std::vector<Entry> parked_;               // fit, but unsafe when last tried
+    WakeupOrder order_{WakeupOrder::Fifo};
+    uint64_t next_seq_{0};
+    size_t size_{0};                          // entries in heaps_ and parked_
+
+    void place(Entry e, const int* claim, const std::vector<int>& available);
+    void push(size_t j, Entry e, const int* claim);   // into heaps_[j]
+};
@@ -0,0 +1,228 @@
+#include "workload.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) parts.push_back(item);
+    return parts;
+}
+
+double to_double(const std::string& key, const std::string& v) {
+    size_t used = 0;
+    double d = std::stod(v, &used);
+    if (used != v.size()) throw std::invalid_argument("workload " + key + ": bad number " + v);
+    return d;
+}
+
+long long to_int(const std::string& key, const std::string& v) {
+    size_t used = 0;
+    long long x = std::stoll(v, &used);
+    if (used != v.size()) throw std::invalid_argument("workload " + key + ": bad integer " + v);
+    return x;
+}
+
+void check(bool ok, const char* what) {
+    if (!ok) throw std::invalid_argument(std::string("workload: ") + what);
+}
+
+} // namespace
+
+WorkloadConfig parse_workload_spec(const std::string& spec) {
+    WorkloadConfig cfg;
+    for (const std::string& item : split(spec, ',')) {
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) throw std::invalid_argument("workload: expected key=value, got " + item);
+        std::string key = item.substr(0, eq), v = item.substr(eq + 1);
+
+        if (key == "n") cfg.count = static_cast<uint64_t>(to_int(key, v));
+        else if (key == "m") cfg.resources = static_cast<size_t>(to_int(key, v));
+        else if (key == "seed") cfg.seed = static_cast<uint64_t>(to_int(key, v));
+        else if (key == "arrivals") {
+            if (v == "poisson") cfg.arrivals = ArrivalModel::Poisson;
+            else if (v == "bursty") cfg.arrivals = ArrivalModel::Bursty;
+            else throw std::invalid_argument("workload: unknown arrivals " + v);
+        }
+        else if (key == "rate") cfg.rate = to_double(key, v);
+        else if (key == "group") cfg.group = to_double(key, v);
+        else if (key == "factor") cfg.factor = to_double(key, v);
+        else if (key == "bursts") {
+            if (v == "exp") cfg.bursts = BurstModel::Exponential;
+            else if (v == "pareto") cfg.bursts = BurstModel::Pareto;
+            else throw std::invalid_argument("workload: unknown bursts " + v);
+        }
+        else if (key == "mean-burst") cfg.mean_burst = to_double(key, v);
+        else if (key == "alpha") cfg.alpha = to_double(key, v);
+        else if (key == "max-burst") cfg.max_burst = static_cast<int>(to_int(key, v));
+        else if (key == "priorities") {
+            cfg.priority_weights.clear();
+            for (const auto& w : split(v, ':')) cfg.priority_weights.push_back(to_double(key, w));
+        }
+        else if (key == "claims") {
+            cfg.max_claim.clear();
+            for (const auto& c : split(v, ':')) cfg.max_claim.push_back(static_cast<int>(to_int(key, c)));
+        }
+        else if (key == "correlation") cfg.correlation = to_double(key, v);
+        else if (key == "slack") cfg.deadline_slack = to_double(key, v);
+        else if (key == "io") cfg.io_requests = static_cast<int>(to_int(key, v));
+        else if (key == "mean-io") cfg.mean_io = to_double(key, v);
+        else if (key == "devices") cfg.devices = static_cast<int>(to_int(key, v));
+        else throw std::invalid_argument("workload: unknown key " + key);
+    }
+    return cfg;
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& cfg, uint64_t stream) : cfg_(cfg) {
+    check(cfg_.resources >= 1, "m must be >= 1");
+    check(cfg_.first_pid >= 0 && cfg_.count <= static_cast<uint64_t>(INT_MAX - cfg_.first_pid),
+          "pids do not fit in int");
+    check(cfg_.rate > 0, "rate must be > 0");
+    check(cfg_.group >= 1 && cfg_.factor >= 1, "group and factor must be >= 1");
+    check(cfg_.mean_burst >= 1 && cfg_.max_burst >= 1, "bursts must be >= 1");
+    check(cfg_.bursts != BurstModel::Pareto || cfg_.alpha > 1, "pareto alpha must be > 1");
+    check(cfg_.correlation >= 0 && cfg_.correlation <= 1, "correlation must be in [0, 1]");
+    check(cfg_.deadline_slack >= 0, "slack must be >= 0");
+    check(cfg_.max_claim.size() == 1 || cfg_.max_claim.size() == cfg_.resources,
+          "claims needs one value or one per resource");
+    for (int c : cfg_.max_claim) check(c >= 0, "claims must be >= 0");
+    check(cfg_.io_requests >= 0, "io must be >= 0");
+    check(cfg_.mean_io >= 1 && cfg_.devices >= 1, "mean-io and devices must be >= 1");
+
+    double sum = 0;
+    for (double w : cfg_.priority_weights) {
+        check(w >= 0, "priority weights must be >= 0");
+        sum += w;
+        priority_cdf_.push_back(sum);
+    }
+    check(sum > 0, "priority weights must not all be 0");
+
+    max_claim_.assign(cfg_.resources, cfg_.max_claim[0]);
+    if (cfg_.max_claim.size() == cfg_.resources) max_claim_ = cfg_.max_claim;
+    pareto_min_ = cfg_.mean_burst * (cfg_.alpha - 1) / cfg_.alpha;
+
+    uint64_t x = cfg_.seed ^ splitmix64(stream);
+    for (auto& s : s_) s = splitmix64(x);
+}
+
+GeneratorState WorkloadGenerator::state() const {
+    GeneratorState st{};
+    std::copy(std::begin(s_), std::end(s_), st.s);
+    st.clock = clock_;
+    st.group_left = group_left_;
+    return st;
+}
+
+void WorkloadGenerator::resume(const GeneratorState& st) {
+    std::copy(std::begin(st.s), std::end(st.s), s_);
+    clock_ = st.clock;
+    group_left_ = st.group_left;
+    produced_ = 0;
+}
+
+uint64_t WorkloadGenerator::next_u64() {
+    uint64_t r = rotl(s_[0] + s_[3], 23) + s_[0];
+    uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return r;
+}
+
+double WorkloadGenerator::uniform() { return static_cast<double>(next_u64() >> 11) * 0x1.0p-53; }
+
+double WorkloadGenerator::exponential(double rate) { return -std::log1p(-uniform()) / rate; }
+
+int WorkloadGenerator::next_arrival() {
+    if (cfg_.arrivals == ArrivalModel::Poisson) {
+        clock_ += exponential(cfg_.rate);
+    } else {
+        double fast = cfg_.rate * cfg_.factor;
+        if (group_left_ == 0) {
+            // Geometric group size; the gap before it keeps the mean rate at `rate`
+            double p = 1.0 / cfg_.group;
+            group_left_ = p >= 1 ? 1 : 1 + static_cast<uint64_t>(std::log1p(-uniform()) / std::log1p(-p));
+            double gap = cfg_.group / cfg_.rate - (cfg_.group - 1) / fast;
+            clock_ += exponential(1.0 / gap);
+        } else {
+            clock_ += exponential(fast);
+        }
+        group_left_--;
+    }
+    return clock_ >= INT_MAX ? INT_MAX : static_cast<int>(clock_);
+}
+
+int WorkloadGenerator::next_burst() {
+    double b = cfg_.bursts == BurstModel::Exponential
+                   ? exponential(1.0 / cfg_.mean_burst)
+                   : pareto_min_ / std::pow(1.0 - uniform(), 1.0 / cfg_.alpha);
+    return static_cast<int>(std::clamp(std::ceil(b), 1.0, static_cast<double>(cfg_.max_burst)));
+}
+
+int WorkloadGenerator::next_priority() {
+    double u = uniform() * priority_cdf_.back();
+    auto it = std::upper_bound(priority_cdf_.begin(), priority_cdf_.end(), u);
+    size_t i = std::min(static_cast<size_t>(it - priority_cdf_.begin()), priority_cdf_.size() - 1);
+    return static_cast<int>(i) + 1;
+}
+
+bool WorkloadGenerator::next(Process& out) {
+    if (produced_ == cfg_.count) return false;
+
+    out.pid = cfg_.first_pid + static_cast<int>(produced_++);
+    out.arrival_time = next_arrival();
+    out.burst_time = next_burst();
+    out.remaining_time = out.burst_time;
+    out.priority = next_priority();
+    out.deadline = cfg_.deadline_slack > 0
+                       ? out.arrival_time + static_cast<int>(std::ceil(cfg_.deadline_slack * out.burst_time))
+                       : -1;
+    out.start_time = -1;
+    out.finish_time = -1;
+
+    double shared = uniform(), c = cfg_.correlation;
+    out.max_need.resize(cfg_.resources);
+    for (size_t j = 0; j < cfg_.resources; j++) {
+        double u = c * shared + (1 - c) * uniform();
+        out.max_need[j] = std::min(max_claim_[j], static_cast<int>(u * (max_claim_[j] + 1)));
+    }
+    next_io(out);
+    return true;
+}
+
+// Drawn last, and only when enabled, so CPU-only streams stay as they were
+void WorkloadGenerator::next_io(Process& out) {
+    out.io.clear();
+    int k = std::min(cfg_.io_requests, out.burst_time - 1);
+    for (int i = 0; i < k; i++) {
+        int at = 1 + static_cast<int>(uniform() * (out.burst_time - 1));
+        int duration = static_cast<int>(std::min(std::ceil(exponential(1.0 / cfg_.mean_io)), 1e9));
+        int device = static_cast<int>(uniform() * cfg_.devices);
+        out.io.push_back({at, std::max(duration, 1), device});
+    }
+    // Requests at the same point of the burst merge into the first one
+    std::sort(out.io.begin(), out.io.end(), [](const IoRequest& a, const IoRequest& b) { return a.at < b.at; });
+    out.io.erase(std::unique(out.io.begin(), out.io.end(),
+                             [](const IoRequest& a, const IoRequest& b) { return a.at == b.at; }),
+                 out.io.end());
+}
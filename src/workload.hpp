@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "trace.hpp"
+
+// Seeded synthetic workloads. A generator is a TraceSource, so anything
+// that replays a trace can replay a generated workload without a file.
+// The same config, seed and stream always produce the same processes.
+
+enum class ArrivalModel {
+    Poisson,   // exponential gaps at `rate`
+    Bursty,    // geometric groups of mean `group`, arriving `factor` times
+               // faster than the gaps between groups; mean rate stays `rate`
+};
+
+enum class BurstModel {
+    Exponential,  // mean `mean_burst`
+    Pareto,       // heavy tail with index `alpha` (> 1) and mean `mean_burst`
+};
+
+struct WorkloadConfig {
+    uint64_t seed{1};
+    uint64_t count{1000};          // processes to generate
+    int first_pid{1};              // pids are first_pid, first_pid + 1, ...
+    size_t resources{3};           // m
+
+    ArrivalModel arrivals{ArrivalModel::Poisson};
+    double rate{1.0};              // mean arrivals per time unit
+    double group{16};              // bursty: mean processes per group
+    double factor{20};             // bursty: speed-up inside a group
+
+    BurstModel bursts{BurstModel::Pareto};
+    double mean_burst{8};
+    double alpha{1.5};
+    int max_burst{100000};         // cap on a single burst
+
+    // Weight of priority 1, 2, .. (lower number = higher priority)
+    std::vector<double> priority_weights{1, 1, 1, 1, 1};
+
+    // Claims are drawn in [0, max_claim[j]] (one value applies to every
+    // resource); with correlation c the draw for each resource is
+    // c * shared + (1 - c) * own, so big processes tend to be big everywhere
+    std::vector<int> max_claim{2};
+    double correlation{0.5};
+
+    // > 0: deadline = arrival + ceil(slack * burst)
+    double deadline_slack{0};
+
+    // Up to io_requests blocking I/O requests per process, at random points
+    // of its CPU burst, each on a random one of `devices` for about mean_io
+    // (exponential). 0 => CPU-only processes.
+    int io_requests{0};
+    double mean_io{10};
+    int devices{1};
+};
+
+// "key=value,..." with keys n, m, seed, arrivals (poisson|bursty), rate,
+// group, factor, bursts (exp|pareto), mean-burst, alpha, max-burst,
+// priorities (weights w1:w2:..), claims (c or c1:c2:..), correlation, slack,
+// io, mean-io, devices.
+// Throws invalid_argument on an unknown key or a bad value.
+WorkloadConfig parse_workload_spec(const std::string& spec);
+
+// Everything a generator has drawn so far besides its pid count: the
+// xoshiro state, the arrival clock and the bursty group in progress
+struct GeneratorState {
+    uint64_t s[4];
+    double clock;
+    uint64_t group_left;
+};
+
+class WorkloadGenerator : public TraceSource {
+public:
+    // stream selects an independent sequence of the same distributions
+    // (e.g. one per producer thread); throws invalid_argument on a bad config
+    explicit WorkloadGenerator(const WorkloadConfig& cfg, uint64_t stream = 0);
+
+    bool next(Process& out) override;
+    size_t resources() const override { return cfg_.resources; }
+
+    GeneratorState state() const;
+    // Continues the stream from a state() of a generator with the same
+    // config; pids start again at first_pid
+    void resume(const GeneratorState& st);
+
+private:
+    WorkloadConfig cfg_;
+    uint64_t s_[4];              // xoshiro256++ state
+    uint64_t produced_{0};
+    double clock_{0};
+    uint64_t group_left_{0};
+    double pareto_min_{0};
+    std::vector<double> priority_cdf_;
+    std::vector<int> max_claim_;  // one per resource
+
+    uint64_t next_u64();
+    double uniform();             // [0, 1)
+    double exponential(double rate);
+    int next_arrival();
+    int next_burst();
+    int next_priority();
+    void next_io(Process& out);
+};
@@ -0,0 +1,148 @@
+// Optimistic admission (ConcurrentAdmission) against serial request_batch.
+//
+// Serial: dispatchers take turns, so every commit is exact and each
+// replica catches up from the commit log; decisions and the final state
+// must equal one Bankers running request_batch on the same batches.
+// Concurrent: four dispatchers race; the final state must conserve the
+// total, leave admitted processes needing nothing, and be safe.
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "../src/admission.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what, int round) {
+    if (ok) return;
+    if (failures++ < 10) std::printf("FAIL round %d: %s\n", round, what);
+}
+
+// pid_span 0: pids pid_base, pid_base + 1, ..
+std::vector<Process> random_batch(std::mt19937& rng, size_t m, int pid_base, int pid_span, int max_claim) {
+    std::vector<Process> batch;
+    int k = 1 + static_cast<int>(rng() % 8);
+    for (int i = 0; i < k; i++) {
+        size_t width = rng() % 25 == 0 ? m + 1 : m;  // rejected for its width
+        std::vector<int> claim(width);
+        for (auto& c : claim) c = static_cast<int>(rng() % max_claim);
+        int pid = pid_base + (pid_span ? static_cast<int>(rng() % pid_span) : i);
+        batch.emplace_back(pid, 0, 1, 1, claim);
+    }
+    return batch;
+}
+
+std::vector<const Process*> pointers(const std::vector<Process>& batch) {
+    std::vector<const Process*> out;
+    for (const auto& p : batch) out.push_back(&p);
+    return out;
+}
+
+void serial_round(int round) {
+    std::mt19937 rng(round);
+    size_t m = 1 + rng() % 6;
+    std::vector<int> total(m);
+    for (auto& t : total) t = 4 + static_cast<int>(rng() % 12);
+
+    Bankers master(total), reference(total);
+    ConcurrentAdmission admission(master);
+    std::vector<ConcurrentAdmission::Replica> replicas;
+    for (int r = 0; r < 3; r++) replicas.emplace_back(master);
+
+    std::vector<int> seen_pids;
+    // Enough batches to run replicas past the commit log now and then
+    int batches = round % 5 == 0 ? 700 : 120;
+    for (int b = 0; b < batches; b++) {
+        // Pids repeat across batches, so later batches change existing rows
+        auto batch = random_batch(rng, m, 1, 200, round % 3 == 0 ? 6 : 3);
+        auto ptrs = pointers(batch);
+        size_t r = rng() % 10 == 0 ? 0 : rng() % replicas.size();   // replica 0 lags
+        BatchAdmission got = admission.admit(ptrs, replicas[r]);
+        BatchAdmission want = reference.request_batch(ptrs);
+        check(got.admitted == want.admitted, "decision differs from serial request_batch", round);
+        for (const auto& p : batch) seen_pids.push_back(p.pid);
+    }
+    check(admission.conflicts() == 0 && admission.fallbacks() == 0, "serial commits conflicted", round);
+    check(master.available() == reference.available(), "available differs", round);
+    check(master.process_count() == reference.process_count(), "row count differs", round);
+    for (int pid : seen_pids) {
+        check(master.allocation_of(pid) == reference.allocation_of(pid), "allocation differs", round);
+        check(master.need_of(pid) == reference.need_of(pid), "need differs", round);
+    }
+}
+
+void concurrent_round(int round) {
+    const size_t m = 4;
+    std::vector<int> total = {20, 15, 12, 9};
+    Bankers master(total);
+    ConcurrentAdmission admission(master);
+
+    std::mutex mtx;
+    std::vector<std::vector<int>> claims;   // (pid, claim...) of every candidate
+    std::vector<int> admitted;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(round * 31 + t);
+            ConcurrentAdmission::Replica replica(master);
+            for (int b = 0; b < 20; b++) {
+                // Distinct pids per thread; now and then one claim above the total
+                auto batch = random_batch(rng, m, 1 + t * 100000 + b * 100, 0, b == 15 ? 25 : 4);
+                BatchAdmission got = admission.admit(pointers(batch), replica);
+                std::lock_guard<std::mutex> lock(mtx);
+                for (size_t i = 0; i < batch.size(); i++) {
+                    if (batch[i].max_need.size() != m) continue;
+                    std::vector<int> row = {batch[i].pid};
+                    row.insert(row.end(), batch[i].max_need.begin(), batch[i].max_need.end());
+                    claims.push_back(row);
+                    if (got.admitted[i]) admitted.push_back(batch[i].pid);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::vector<int> sum = master.available();
+    for (int x : sum) check(x >= 0, "negative available", round);
+    for (const auto& c : claims) {
+        auto a = master.allocation_of(c[0]);
+        for (size_t j = 0; j < m; j++) sum[j] += a[j];
+    }
+    check(sum == total, "allocations do not add up to the total", round);
+    for (int pid : admitted)
+        for (int x : master.need_of(pid)) check(x == 0, "admitted process still needs resources", round);
+
+    // Safety of the final state (claims above the total never finish, and
+    // never hold anything)
+    std::vector<int> work = master.available();
+    std::vector<bool> done(claims.size());
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (size_t i = 0; i < claims.size(); i++) {
+            if (done[i]) continue;
+            bool feasible = true, fits = true;
+            auto need = master.need_of(claims[i][0]);
+            for (size_t j = 0; j < m; j++) {
+                if (claims[i][1 + j] > total[j]) feasible = false;
+                if (need[j] > work[j]) fits = false;
+            }
+            if (!feasible) { done[i] = true; continue; }
+            if (!fits) continue;
+            auto a = master.allocation_of(claims[i][0]);
+            for (size_t j = 0; j < m; j++) work[j] += a[j];
+            done[i] = progress = true;
+        }
+    }
+    for (bool d : done) check(d, "final state is unsafe", round);
+}
+
+} // namespace
+
+int main() {
+    for (int round = 0; round < 200; round++) serial_round(round);
+    for (int round = 0; round < 100; round++) concurrent_round(round);
+    std::printf("%s: admission (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
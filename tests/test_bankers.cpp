@@ -0,0 +1,205 @@
+// Bankers (cached safe sequence, O(1) order updates) against a plain
+// Banker's algorithm that runs the full safety check on every grant.
+//
+// Random full-claim admissions, incremental declare/request/release,
+// release_all and request_batch must take the same decisions and leave the
+// same allocations, and every sequence Bankers reports must be a safe
+// sequence of its current state covering every registered pid.
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include "../src/bankers.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what, int round, int step) {
+    if (ok) return;
+    if (failures++ < 10) std::printf("FAIL round %d step %d: %s\n", round, step, what);
+}
+
+struct Row {
+    std::vector<int> max, alloc;
+};
+
+class Reference {
+public:
+    explicit Reference(std::vector<int> available) : available(std::move(available)) {}
+
+    std::vector<int> available;
+    std::map<int, Row> rows;
+
+    bool fits(const std::vector<int>& a, const std::vector<int>& b) const {
+        for (size_t j = 0; j < a.size(); j++)
+            if (a[j] > b[j]) return false;
+        return true;
+    }
+
+    std::vector<int> need(const Row& r) const {
+        std::vector<int> n(r.max.size());
+        for (size_t j = 0; j < n.size(); j++) n[j] = r.max[j] - r.alloc[j];
+        return n;
+    }
+
+    bool safe() const {
+        std::vector<int> work = available;
+        std::map<int, bool> done;
+        for (bool progress = true; progress;) {
+            progress = false;
+            for (const auto& [pid, r] : rows) {
+                if (done[pid] || !fits(need(r), work)) continue;
+                for (size_t j = 0; j < work.size(); j++) work[j] += r.alloc[j];
+                done[pid] = progress = true;
+            }
+        }
+        for (const auto& [pid, r] : rows)
+            if (!done[pid]) return false;
+        return true;
+    }
+
+    // Grants delta to pid if it fits and keeps the state safe
+    bool grant(int pid, const std::vector<int>& delta) {
+        if (!fits(delta, available)) return false;
+        Row& r = rows[pid];
+        for (size_t j = 0; j < delta.size(); j++) {
+            available[j] -= delta[j];
+            r.alloc[j] += delta[j];
+        }
+        if (safe()) return true;
+        for (size_t j = 0; j < delta.size(); j++) {
+            available[j] += delta[j];
+            r.alloc[j] -= delta[j];
+        }
+        return false;
+    }
+
+    bool request_resources(int pid, const std::vector<int>& claim) {
+        Row& r = rows[pid];
+        if (r.alloc.empty()) r.alloc.assign(claim.size(), 0);
+        r.max = claim;
+        return grant(pid, need(r));
+    }
+
+    void release_all(int pid) {
+        auto it = rows.find(pid);
+        if (it == rows.end()) return;
+        for (size_t j = 0; j < available.size(); j++) available[j] += it->second.alloc[j];
+        rows.erase(it);
+    }
+};
+
+// seq is a safe sequence of b's state with every registered pid once
+bool valid_sequence(const Bankers& b, const Reference& ref, const std::vector<int>& seq) {
+    if (seq.size() != ref.rows.size()) return false;
+    std::vector<int> work = b.available();
+    std::map<int, bool> seen;
+    for (int pid : seq) {
+        if (!ref.rows.count(pid) || seen[pid]) return false;
+        seen[pid] = true;
+        auto need = b.need_of(pid), alloc = b.allocation_of(pid);
+        if (!ref.fits(need, work)) return false;
+        for (size_t j = 0; j < work.size(); j++) work[j] += alloc[j];
+    }
+    return true;
+}
+
+std::vector<int> random_vector(std::mt19937& rng, size_t m, int bound) {
+    std::vector<int> v(m);
+    for (auto& x : v) x = static_cast<int>(rng() % (bound + 1));
+    return v;
+}
+
+void round_trip(int round) {
+    std::mt19937 rng(round);
+    size_t m = 1 + rng() % 5;
+    std::vector<int> total = random_vector(rng, m, 12);
+    for (auto& t : total) t += 1;
+    Bankers b(total);
+    Reference ref(total);
+    int pids = 4 + static_cast<int>(rng() % 60);
+    int claim_bound = round % 4 == 0 ? 14 : 5;   // now and then above the total
+    // Some rounds are mostly large batches over few pids, so candidates
+    // often change their claim and get revoked
+    bool batch_heavy = round % 3 == 1;
+    if (batch_heavy) pids = 4 + static_cast<int>(rng() % 12);
+
+    for (int step = 0; step < 400; step++) {
+        int pid = static_cast<int>(rng() % pids);
+        int op = static_cast<int>(rng() % 10);
+        if (batch_heavy && op < 4) op = 8;
+        if (op < 4) {
+            auto claim = random_vector(rng, m, claim_bound);
+            auto got = op == 0 ? b.request_resources(pid, claim)
+                               : (b.admit(pid, claim.data(), m) ? std::optional<std::vector<int>>(std::vector<int>{})
+                                                                : std::nullopt);
+            bool want = ref.request_resources(pid, claim);
+            check(got.has_value() == want, "admission decision differs", round, step);
+            if (op == 0 && got) check(valid_sequence(b, ref, *got), "returned sequence is not safe", round, step);
+        } else if (op < 6) {
+            b.release_all(pid);
+            ref.release_all(pid);
+        } else if (op == 6) {
+            // Incremental: a claim no lower than what pid holds, then part of it
+            auto it = ref.rows.find(pid);
+            auto claim = random_vector(rng, m, claim_bound);
+            if (it != ref.rows.end())
+                for (size_t j = 0; j < m; j++) claim[j] = std::max(claim[j], it->second.alloc[j]);
+            b.declare(pid, ResourceVector(claim));
+            Row& r = ref.rows[pid];
+            if (r.alloc.empty()) r.alloc.assign(m, 0);
+            r.max = claim;
+            auto need = ref.need(r);
+            std::vector<int> delta(m);
+            for (size_t j = 0; j < m; j++) delta[j] = need[j] ? static_cast<int>(rng() % (need[j] + 1)) : 0;
+            Grant g = b.request(pid, ResourceVector(delta));
+            bool want = ref.grant(pid, delta);
+            check((g == Grant::Granted) == want, "incremental decision differs", round, step);
+        } else if (op == 7) {
+            auto it = ref.rows.find(pid);
+            if (it == ref.rows.end()) continue;
+            std::vector<int> delta(m);
+            for (size_t j = 0; j < m; j++)
+                delta[j] = it->second.alloc[j] ? static_cast<int>(rng() % (it->second.alloc[j] + 1)) : 0;
+            b.release(pid, ResourceVector(delta));
+            for (size_t j = 0; j < m; j++) {
+                it->second.alloc[j] -= delta[j];
+                ref.available[j] += delta[j];
+            }
+        } else {
+            // request_batch keeps the cached order when it can; mirror its outcome
+            std::vector<Process> batch;
+            int k = 1 + static_cast<int>(rng() % (batch_heavy ? 16 : 6));
+            for (int i = 0; i < k; i++)
+                batch.emplace_back(static_cast<int>(rng() % pids), 0, 1, 1, random_vector(rng, m, claim_bound));
+            b.request_batch(batch);
+            ref.available = b.available();
+            for (const auto& p : batch) {
+                auto alloc = b.allocation_of(p.pid), need = b.need_of(p.pid);
+                Row& r = ref.rows[p.pid];
+                r.alloc = alloc;
+                r.max.resize(m);
+                for (size_t j = 0; j < m; j++) r.max[j] = alloc[j] + need[j];
+            }
+        }
+
+        check(b.available() == ref.available, "available differs", round, step);
+        check(b.process_count() == ref.rows.size(), "row count differs", round, step);
+        for (const auto& [p, r] : ref.rows) {
+            check(b.allocation_of(p) == r.alloc, "allocation differs", round, step);
+            check(b.need_of(p) == ref.need(r), "need differs", round, step);
+        }
+        auto seq = b.safe_sequence();
+        if (ref.safe()) check(valid_sequence(b, ref, seq), "safe_sequence is not safe", round, step);
+        else check(seq.empty(), "safe_sequence of an unsafe state", round, step);
+    }
+}
+
+} // namespace
+
+int main() {
+    for (int round = 0; round < 300; round++) round_trip(round);
+    std::printf("%s: bankers (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
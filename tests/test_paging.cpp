@@ -0,0 +1,222 @@
+// Page replacement (Pager over FIFO/LRU/CLOCK/ARC, with and without TLB)
+// against straightforward list- and map-based reference policies.
+//
+// Generated traces with several processes, phases, scans and (except for
+// ARC) exits must produce exactly the reference fault counts. Some traces
+// move half of the processes' pages near 2^32 to exercise the sparse top
+// level of the page table.
+#include <algorithm>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include "../src/paging.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    if (failures++ < 10) std::printf("FAIL %s\n", what.c_str());
+}
+
+using Key = uint64_t;
+
+Key key_of(const MemRef& r) { return (uint64_t(uint32_t(r.pid)) << 32) | r.page; }
+uint32_t pid_of(Key k) { return static_cast<uint32_t>(k >> 32); }
+
+// FIFO (lru = false) or LRU over one list, most recent at the front
+uint64_t reference_list(const std::vector<MemRef>& refs, uint32_t frames, bool lru) {
+    std::list<Key> order;
+    std::unordered_map<Key, std::list<Key>::iterator> where;
+    uint64_t faults = 0;
+    for (const MemRef& r : refs) {
+        if (r.page == kExitPage) {
+            for (auto it = order.begin(); it != order.end();) {
+                if (pid_of(*it) != uint32_t(r.pid)) { ++it; continue; }
+                where.erase(*it);
+                it = order.erase(it);
+            }
+            continue;
+        }
+        Key k = key_of(r);
+        auto it = where.find(k);
+        if (it != where.end()) {
+            if (lru) order.splice(order.begin(), order, it->second);
+            continue;
+        }
+        faults++;
+        if (order.size() == frames) {
+            where.erase(order.back());
+            order.pop_back();
+        }
+        order.push_front(k);
+        where[k] = order.begin();
+    }
+    return faults;
+}
+
+// CLOCK over frame slots; free frames are reused last-freed first, and an
+// exit frees its pages in page order
+uint64_t reference_clock(const std::vector<MemRef>& refs, uint32_t frames) {
+    std::vector<Key> owner(frames, ~0ull);
+    std::vector<bool> referenced(frames, false);
+    std::unordered_map<Key, uint32_t> frame_of;
+    std::vector<uint32_t> free;
+    for (uint32_t f = frames; f-- > 0;) free.push_back(f);
+    uint32_t hand = 0;
+    uint64_t faults = 0;
+    for (const MemRef& r : refs) {
+        if (r.page == kExitPage) {
+            std::vector<std::pair<uint32_t, uint32_t>> mine;   // (page, frame)
+            for (const auto& [k, f] : frame_of)
+                if (pid_of(k) == uint32_t(r.pid)) mine.push_back({static_cast<uint32_t>(k), f});
+            std::sort(mine.begin(), mine.end());
+            for (const auto& [page, f] : mine) {
+                frame_of.erase((uint64_t(uint32_t(r.pid)) << 32) | page);
+                referenced[f] = false;
+                owner[f] = ~0ull;
+                free.push_back(f);
+            }
+            continue;
+        }
+        Key k = key_of(r);
+        auto it = frame_of.find(k);
+        if (it != frame_of.end()) {
+            referenced[it->second] = true;
+            continue;
+        }
+        faults++;
+        uint32_t f;
+        if (!free.empty()) {
+            f = free.back();
+            free.pop_back();
+        } else {
+            while (referenced[hand]) {
+                referenced[hand] = false;
+                hand = (hand + 1) % frames;
+            }
+            f = hand;
+            hand = (hand + 1) % frames;
+            frame_of.erase(owner[f]);
+        }
+        owner[f] = k;
+        referenced[f] = true;
+        frame_of[k] = f;
+    }
+    return faults;
+}
+
+// ARC as in Megiddo & Modha, Fig. 4 (no exits)
+uint64_t reference_arc(const std::vector<MemRef>& refs, uint32_t c) {
+    std::list<Key> lists[4];   // T1, T2, B1, B2
+    enum { T1, T2, B1, B2 };
+    std::unordered_map<Key, std::pair<int, std::list<Key>::iterator>> where;
+    double p = 0;
+    uint64_t faults = 0;
+    auto move = [&](Key k, int to) {
+        auto& e = where[k];
+        lists[to].splice(lists[to].begin(), lists[e.first], e.second);
+        e = {to, lists[to].begin()};
+    };
+    auto drop_lru = [&](int l) {
+        where.erase(lists[l].back());
+        lists[l].pop_back();
+    };
+    auto replace = [&](bool in_b2) {
+        double t1 = static_cast<double>(lists[T1].size());
+        if (!lists[T1].empty() && (t1 > p || (in_b2 && t1 == p) || lists[T2].empty())) move(lists[T1].back(), B1);
+        else move(lists[T2].back(), B2);
+    };
+    for (const MemRef& r : refs) {
+        Key k = key_of(r);
+        auto it = where.find(k);
+        int in = it == where.end() ? -1 : it->second.first;
+        if (in == T1 || in == T2) {
+            move(k, T2);
+            continue;
+        }
+        faults++;
+        if (in == B1) {
+            p = std::min<double>(c, p + std::max<size_t>(1, lists[B2].size() / lists[B1].size()));
+            replace(false);
+            move(k, T2);
+            continue;
+        }
+        if (in == B2) {
+            p = std::max<double>(0, p - std::max<size_t>(1, lists[B1].size() / lists[B2].size()));
+            replace(true);
+            move(k, T2);
+            continue;
+        }
+        size_t l1 = lists[T1].size() + lists[B1].size();
+        size_t all = l1 + lists[T2].size() + lists[B2].size();
+        if (l1 == c) {
+            if (lists[T1].size() < c) {
+                drop_lru(B1);
+                replace(false);
+            } else {
+                drop_lru(T1);
+            }
+        } else if (all >= c) {
+            if (all == 2 * c) drop_lru(B2);
+            replace(false);
+        }
+        lists[T1].push_front(k);
+        where[k] = {T1, lists[T1].begin()};
+    }
+    return faults;
+}
+
+} // namespace
+
+int main() {
+    const std::string path = "/tmp/test_paging_" + std::to_string(getpid()) + ".refs";
+    for (int trial = 0; trial < 40; trial++) {
+        RefConfig cfg;
+        cfg.seed = trial + 1;
+        cfg.count = 100000;
+        cfg.processes = 1 + trial % 5;
+        cfg.pages = 64 + trial * 13;
+        cfg.hot = 8 + trial;
+        cfg.hot_prob = 0.7;
+        cfg.phase = 5000;
+        cfg.run = 300;
+        cfg.scan = 0.1;
+        cfg.life = trial % 2 ? 20000 : 0;
+        write_ref_trace(path, cfg);
+        std::vector<MemRef> refs;
+        {
+            RefTrace trace(path);
+            refs.assign(trace.data(), trace.data() + trace.size());
+        }
+        if (trial % 4 >= 2)
+            for (MemRef& r : refs)
+                if (r.page != kExitPage && r.pid % 2) r.page = kExitPage - 1 - r.page * 1031;
+
+        uint32_t frames = 16 + trial * 7;
+        for (Replacement policy : {Replacement::Fifo, Replacement::Lru, Replacement::Clock, Replacement::Arc}) {
+            std::string name = "trial " + std::to_string(trial) + " " + replacement_name(policy);
+            if (policy == Replacement::Arc && cfg.life) {
+                // Exits are outside the published algorithm: only sanity
+                PagingStats st = simulate_paging(refs.data(), refs.size(), {policy, frames, 64});
+                check(st.faults > 0 && st.exits > 0 && st.faults <= st.references, name + ": implausible counts");
+                continue;
+            }
+            uint64_t want = policy == Replacement::Fifo  ? reference_list(refs, frames, false)
+                          : policy == Replacement::Lru   ? reference_list(refs, frames, true)
+                          : policy == Replacement::Clock ? reference_clock(refs, frames)
+                                                         : reference_arc(refs, frames);
+            for (uint32_t tlb : {0u, 64u}) {
+                PagingStats st = simulate_paging(refs.data(), refs.size(), {policy, frames, tlb});
+                check(st.faults == want, name + " tlb " + std::to_string(tlb) + ": " + std::to_string(st.faults) +
+                                             " faults, reference " + std::to_string(want));
+            }
+        }
+    }
+    std::remove(path.c_str());
+    std::printf("%s: paging (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+// RoundRobinRounds (event-compressed) against plain round_robin.
+//
+// Random workloads with varied arrival spreads, bursts (including zero),
+// quanta and queue depths: the expanded compressed Gantt must equal the
+// per-quantum Gantt slice for slice, the streamed (sink) output must match
+// too, and finish time, averages and per-process times must be identical.
+// The compressed Gantt must stay linear in the number of processes.
+#include <cstdio>
+#include <random>
+#include "../src/gantt.hpp"
+#include "../src/scheduler.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what, int round) {
+    if (ok) return;
+    if (failures++ < 10) std::printf("FAIL round %d: %s\n", round, what);
+}
+
+class CollectSink : public GanttSink {
+public:
+    std::vector<GanttSlice> slices;
+
+protected:
+    void on_slice(const GanttSlice& s) override { slices.push_back(s); }
+};
+
+bool same(const std::vector<GanttSlice>& a, const std::vector<GanttSlice>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); k++)
+        if (a[k].pid != b[k].pid || a[k].start != b[k].start || a[k].end != b[k].end) return false;
+    return true;
+}
+
+bool same(const std::vector<ProcessTimes>& a, const std::vector<ProcessTimes>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); k++)
+        if (a[k].pid != b[k].pid || a[k].waiting != b[k].waiting || a[k].turnaround != b[k].turnaround ||
+            a[k].response != b[k].response)
+            return false;
+    return true;
+}
+
+void compare(int round) {
+    std::mt19937 rng(round);
+    int n = 1 + static_cast<int>(rng() % (round % 10 == 0 ? 400 : 40));
+    int quantum = 1 + static_cast<int>(rng() % 6);
+    int spread = 1 + static_cast<int>(rng() % (round % 3 == 0 ? 5 : 300));   // dense or sparse arrivals
+    int max_burst = 1 + static_cast<int>(rng() % (round % 2 ? 80 : 8));
+    std::vector<Process> procs;
+    for (int k = 0; k < n; k++)
+        procs.emplace_back(k + 1, static_cast<int>(rng() % spread), static_cast<int>(rng() % max_burst), 0,
+                           std::vector<int>{1});
+
+    ScheduleResult rr = Scheduler::run(procs, SchedPolicy::RoundRobin, quantum, StatsDetail::PerProcess);
+    ScheduleResult rounds = Scheduler::run(procs, SchedPolicy::RoundRobinRounds, quantum, StatsDetail::PerProcess);
+    check(same(Scheduler::expand_rounds(rounds), rr.gantt), "expanded Gantt differs", round);
+    check(rounds.rounds.size() <= 5 * procs.size() + 1, "compressed Gantt not linear", round);
+    check(rounds.finish_time == rr.finish_time, "finish time differs", round);
+    check(rounds.avg_waiting == rr.avg_waiting && rounds.avg_turnaround == rr.avg_turnaround,
+          "averages differ", round);
+    check(same(rounds.per_process, rr.per_process), "per-process times differ", round);
+
+    CollectSink a, b;
+    Scheduler::run(procs, SchedPolicy::RoundRobin, quantum, a);
+    Scheduler::run(procs, SchedPolicy::RoundRobinRounds, quantum, b);
+    check(same(a.slices, b.slices), "streamed Gantt differs", round);
+}
+
+} // namespace
+
+int main() {
+    for (int round = 0; round < 5000; round++) compare(round);
+    std::printf("%s: round robin rounds (%d failures)\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}